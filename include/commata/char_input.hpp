@@ -8,6 +8,8 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdlib>
+#include <ios>
 #include <istream>
 #include <limits>
 #include <memory>
@@ -17,6 +19,7 @@
 #include <type_traits>
 #include <utility>
 
+#include "detail/exceptions.hpp"
 #include "detail/typing_aid.hpp"
 
 namespace commata {
@@ -55,6 +58,80 @@ auto read(In& in,
     return m;
 }
 
+// Reads chars which are available without blocking, waiting only until the
+// first one arrives; eof is set if the end of the input has been reached
+template <class Ch, class Tr>
+std::streamsize getsome(std::basic_streambuf<Ch, Tr>& in,
+    Ch* out, std::streamsize n, bool& eof)
+{
+    if (Tr::eq_int_type(in.sgetc(), Tr::eof())) {
+        eof = true;
+        return 0;
+    }
+    return in.sgetn(out, std::min(n, std::max<std::streamsize>(
+        in.in_avail(), 1)));
+}
+
+template <class Ch, class Tr>
+std::streamsize getsome(std::basic_istream<Ch, Tr>& in,
+    Ch* out, std::streamsize n, bool& eof)
+{
+    if (Tr::eq_int_type(in.peek(), Tr::eof())) {
+        eof = true;
+        return 0;
+    }
+    const auto m = in.readsome(out, n);
+    if (m > 0) {
+        return m;
+    }
+    // The streambuf does not tell how many chars are available
+    in.read(out, 1);
+    return in.gcount();
+}
+
+// Gives access to the get area of any streambuf, which is exposed only to
+// derived classes; this class is never instantiated
+template <class Ch, class Tr>
+struct get_area : std::basic_streambuf<Ch, Tr>
+{
+    static std::pair<Ch*, Ch*> of(std::basic_streambuf<Ch, Tr>& in)
+        noexcept
+    {
+        return { (in.*(&get_area::gptr))(), (in.*(&get_area::egptr))() };
+    }
+
+    static void bump(std::basic_streambuf<Ch, Tr>& in, int n)
+    {
+        (in.*(&get_area::gbump))(n);
+    }
+};
+
+// Removes up to n chars at the front of the get area of in, which is filled
+// first if it is empty, and returns them; if in does not use its get area,
+// one char is read into c instead
+template <class Ch, class Tr>
+std::pair<const Ch*, std::size_t> take_get_area(
+    std::basic_streambuf<Ch, Tr>& in, std::size_t n, Ch& c, bool& eof)
+{
+    const auto ch = in.sgetc();
+    if (Tr::eq_int_type(ch, Tr::eof())) {
+        eof = true;
+        return { nullptr, 0 };
+    }
+    const auto [first, last] = get_area<Ch, Tr>::of(in);
+    if (first == last) {
+        // The streambuf does not use its get area
+        c = Tr::to_char_type(ch);
+        in.sbumpc();
+        return { &c, 1 };
+    }
+    constexpr std::size_t nmax = std::numeric_limits<int>::max();
+    const auto length = std::min({ static_cast<std::size_t>(last - first),
+                                   n, nmax });
+    get_area<Ch, Tr>::bump(in, static_cast<int>(length));
+    return { first, length };
+}
+
 } // end detail::input
 
 template <class Ch, class Tr = std::char_traits<Ch>>
@@ -223,6 +300,160 @@ auto swap(owned_istream_input<IStream>& left,
     left.swap(right);
 }
 
+// Reads chars from a streambuf or an istream without waiting for the
+// requested number of chars when some have already arrived, and tells the end
+// of the input with eof, so that the parser can handle what has arrived at
+// once
+template <class Stream>
+class partial_read_input
+{
+    Stream* in_;
+    bool eof_;
+
+public:
+    static_assert(
+        std::is_same_v<Stream, std::basic_streambuf<
+            typename Stream::char_type, typename Stream::traits_type>>
+     || std::is_same_v<Stream, std::basic_istream<
+            typename Stream::char_type, typename Stream::traits_type>>);
+
+    using stream_type = Stream;
+    using char_type = typename Stream::char_type;
+    using traits_type = typename Stream::traits_type;
+    using size_type = std::make_unsigned_t<std::streamsize>;
+    using reports_eof = std::true_type;
+
+    partial_read_input() noexcept :
+        in_(nullptr), eof_(true)
+    {}
+
+    explicit partial_read_input(Stream& in) noexcept :
+        in_(std::addressof(in)), eof_(false)
+    {}
+
+    partial_read_input(const partial_read_input& other) = default;
+    partial_read_input& operator=(const partial_read_input&) = default;
+
+    size_type operator()(char_type* out, size_type n)
+    {
+        if (!in_ || eof_ || (n == 0)) {
+            return 0;
+        }
+        constexpr size_type nmax = std::numeric_limits<std::streamsize>::max();
+        return static_cast<size_type>(detail::input::getsome(*in_, out,
+            static_cast<std::streamsize>(std::min(n, nmax)), eof_));
+    }
+
+    bool eof() const noexcept
+    {
+        return eof_;
+    }
+};
+
+// Hands the chars in the get area of a streambuf, or of the streambuf of an
+// istream, to the parser without copying them, and tells the end of the input
+// explicitly with eof; the range given by the direct read is valid until the
+// next read
+template <class Stream>
+class direct_read_input
+{
+    Stream* in_;
+    bool eof_;
+    // Where the char is stored if the streambuf does not use its get area
+    typename Stream::char_type c_;
+
+public:
+    static_assert(
+        std::is_same_v<Stream, std::basic_streambuf<
+            typename Stream::char_type, typename Stream::traits_type>>
+     || std::is_same_v<Stream, std::basic_istream<
+            typename Stream::char_type, typename Stream::traits_type>>);
+
+    using stream_type = Stream;
+    using char_type = typename Stream::char_type;
+    using traits_type = typename Stream::traits_type;
+    using size_type = std::make_unsigned_t<std::streamsize>;
+    using reports_eof = std::true_type;
+
+    direct_read_input() noexcept :
+        in_(nullptr), eof_(true), c_()
+    {}
+
+    explicit direct_read_input(Stream& in) noexcept :
+        in_(std::addressof(in)), eof_(false), c_()
+    {}
+
+    direct_read_input(const direct_read_input& other) = default;
+    direct_read_input& operator=(const direct_read_input&) = default;
+
+    size_type operator()(char_type* out, size_type n)
+    {
+        if (!in_ || eof_) {
+            return 0;
+        }
+        const auto length = detail::input::read(*in_, out, n);
+        eof_ = (length < n);
+        return length;
+    }
+
+    std::pair<const char_type*, size_type> operator()(size_type n)
+    {
+        if (!in_ || eof_ || (n == 0)) {
+            return { nullptr, 0 };
+        }
+        std::pair<const char_type*, std::size_t> r;
+        if constexpr (std::is_same_v<Stream, std::basic_streambuf<
+                char_type, traits_type>>) {
+            r = detail::input::take_get_area(*in_, n, c_, eof_);
+        } else {
+            // A stream which has failed before must not be taken for one
+            // which has merely ended
+            const bool failed = in_->fail();
+            const typename Stream::sentry s(*in_, true);        // throw
+            if (!s) {
+                eof_ = true;
+                if (failed) {
+                    fail();
+                }
+                return { nullptr, 0 };
+            }
+#ifdef COMMATA_EXCEPTIONS_ENABLED
+            try {
+#endif
+                r = detail::input::take_get_area(
+                    *in_->rdbuf(), n, c_, eof_);                // throw
+#ifdef COMMATA_EXCEPTIONS_ENABLED
+            } catch (...) {
+                eof_ = true;
+                in_->setstate(std::ios_base::badbit);           // throw
+                throw;
+            }
+#endif
+            if (eof_) {
+                in_->setstate(std::ios_base::eofbit);
+            }
+        }
+        return { r.first, static_cast<size_type>(r.second) };
+    }
+
+    bool eof() const noexcept
+    {
+        return eof_;
+    }
+
+private:
+    [[noreturn]] void fail()
+    {
+        in_->setstate(std::ios_base::badbit);                   // throw
+#ifdef COMMATA_EXCEPTIONS_ENABLED
+        throw std::ios_base::failure(
+            "direct_read_input: the stream has failed");
+#else
+        std::abort();
+#endif
+    }
+};
+
 template <class Ch, class Tr = std::char_traits<Ch>>
 class string_input
 {
@@ -382,6 +613,7 @@ public:
     using char_type = typename Input::char_type;
     using traits_type = typename Input::traits_type;
     using size_type = typename Input::size_type;
+    using reports_eof = std::bool_constant<detail::reports_eof_v<Input>>;
 
     explicit indirect_input(Input input)
         noexcept(std::is_nothrow_move_constructible_v<Input>) :
@@ -410,6 +642,14 @@ public:
         return input_(out, n);
     }
 
+    template <class I = Input,
+        std::enable_if_t<detail::reports_eof_v<I>>* = nullptr>
+    auto eof() const noexcept(noexcept(std::declval<const I&>().eof()))
+     -> decltype(std::declval<const I&>().eof())
+    {
+        return input_.eof();
+    }
+
     void swap(indirect_input& other) noexcept(
         std::is_nothrow_swappable_v<Input>)
     {
@@ -431,6 +671,16 @@ struct indirect_t
 
 constexpr inline indirect_t indirect{};
 
+struct partial_read_t
+{};
+
+constexpr inline partial_read_t partial_read{};
+
+struct direct_read_t
+{};
+
+constexpr inline direct_read_t direct_read{};
+
 template <class Ch, class Tr>
 [[nodiscard]] streambuf_input<Ch, Tr> make_char_input(
     std::basic_streambuf<Ch, Tr>& in) noexcept
@@ -445,6 +695,34 @@ template <class Ch, class Tr>
     return istream_input(in);
 }
 
+template <class Ch, class Tr>
+[[nodiscard]] partial_read_input<std::basic_streambuf<Ch, Tr>>
+    make_char_input(partial_read_t, std::basic_streambuf<Ch, Tr>& in) noexcept
+{
+    return partial_read_input(in);
+}
+
+template <class Ch, class Tr>
+[[nodiscard]] partial_read_input<std::basic_istream<Ch, Tr>>
+    make_char_input(partial_read_t, std::basic_istream<Ch, Tr>& in) noexcept
+{
+    return partial_read_input(in);
+}
+
+template <class Ch, class Tr>
+[[nodiscard]] direct_read_input<std::basic_streambuf<Ch, Tr>>
+    make_char_input(direct_read_t, std::basic_streambuf<Ch, Tr>& in) noexcept
+{
+    return direct_read_input(in);
+}
+
+template <class Ch, class Tr>
+[[nodiscard]] direct_read_input<std::basic_istream<Ch, Tr>>
+    make_char_input(direct_read_t, std::basic_istream<Ch, Tr>& in) noexcept
+{
+    return direct_read_input(in);
+}
+
 template <class Streambuf>
 [[nodiscard]] auto make_char_input(Streambuf&& in)
     noexcept(std::is_nothrow_move_constructible_v<
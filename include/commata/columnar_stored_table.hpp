@@ -0,0 +1,485 @@
+/**
+ * These codes are licensed under the Unlicense.
+ * http://unlicense.org
+ */
+
+#ifndef COMMATA_GUARD_3D10C7AD_559C_4041_9318_3800D9241B87
+#define COMMATA_GUARD_3D10C7AD_559C_4041_9318_3800D9241B87
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "stored_table.hpp"
+
+namespace commata {
+
+// One column of a basic_columnar_stored_table; its values are laid out
+// contiguously in one arena of chars, each followed by a terminating zero,
+// and are located with 32-bit offsets
+template <class Ch, class Tr = std::char_traits<Ch>,
+          class Allocator = std::allocator<Ch>>
+class basic_stored_column
+{
+public:
+    using allocator_type = Allocator;
+    using char_type      = Ch;
+    using traits_type    = Tr;
+    using value_type     = basic_stored_value<const Ch, Tr>;
+    using size_type      = std::size_t;
+    using offset_type    = std::uint32_t;
+
+private:
+    using at_t = std::allocator_traits<Allocator>;
+    using oa_t = typename at_t::template rebind_alloc<offset_type>;
+    using wa_t = typename at_t::template rebind_alloc<std::uint64_t>;
+
+    // Chars of the values, each of which is followed by a terminating zero,
+    // and then possibly chars of a value which is being built
+    std::vector<Ch, Allocator> chars_;
+    // offsets_[i] is the offset of the i-th value in chars_, and the last
+    // element is the end of the last value
+    std::vector<offset_type, oa_t> offsets_;
+    // The i-th bit is set if the i-th record has a value in this column
+    std::vector<std::uint64_t, wa_t> presence_;
+
+public:
+    explicit basic_stored_column(const Allocator& alloc = Allocator()) :
+        chars_(alloc), offsets_(1, 0, oa_t(alloc)), presence_(wa_t(alloc))
+    {}
+
+    basic_stored_column(const basic_stored_column&) = default;
+    basic_stored_column(basic_stored_column&&) = default;
+    ~basic_stored_column() = default;
+    basic_stored_column& operator=(const basic_stored_column&) = default;
+    basic_stored_column& operator=(basic_stored_column&&) = default;
+
+    allocator_type get_allocator() const noexcept
+    {
+        return chars_.get_allocator();
+    }
+
+    size_type size() const noexcept
+    {
+        return offsets_.size() - 1;
+    }
+
+    bool empty() const noexcept
+    {
+        return size() == 0;
+    }
+
+    // Returns an empty value for a record which has no value in this column
+    value_type operator[](size_type i) const noexcept
+    {
+        assert(i < size());
+        const Ch* const p = chars_.data();
+        return value_type(p + offsets_[i], p + offsets_[i + 1] - 1);
+    }
+
+    bool has_value(size_type i) const noexcept
+    {
+        assert(i < size());
+        return (presence_[i / 64] >> (i % 64)) & 1U;
+    }
+
+    // The arena of the chars, whose first size_of_chars() chars are those of
+    // the values
+    const Ch* chars() const noexcept
+    {
+        return chars_.data();
+    }
+
+    size_type size_of_chars() const noexcept
+    {
+        return offsets_.back();
+    }
+
+    // The array of size() + 1 offsets of the values in the arena
+    const offset_type* offsets() const noexcept
+    {
+        return offsets_.data();
+    }
+
+    void clear() noexcept
+    {
+        chars_.clear();
+        offsets_.resize(1);
+        presence_.clear();
+    }
+
+    void shrink_to_fit()
+    {
+        chars_.shrink_to_fit();
+        offsets_.shrink_to_fit();
+        presence_.shrink_to_fit();
+    }
+
+    void swap(basic_stored_column& other) noexcept
+    {
+        chars_.swap(other.chars_);
+        offsets_.swap(other.offsets_);
+        presence_.swap(other.presence_);
+    }
+
+private:
+    template <class Ch2, class Tr2, class Allocator2>
+    friend class basic_columnar_stored_table;
+
+    template <class Ch2, class Tr2, class Allocator2>
+    friend class columnar_stored_table_builder;
+
+    // Starts to build a new value, discarding the chars of the value which
+    // has been being built if any
+    void start_value() noexcept
+    {
+        chars_.resize(offsets_.back());
+    }
+
+    // Appends chars to the value which is being built
+    void append(const Ch* first, const Ch* last)
+    {
+        chars_.insert(chars_.end(), first, last);               // throw
+    }
+
+    // Makes the value which has been being built the last value
+    void push_value()
+    {
+        push(true);                                             // throw
+    }
+
+    // Makes the column have n values, padding with missing ones
+    void pad(size_type n)
+    {
+        start_value();
+        while (size() < n) {
+            push(false);                                        // throw
+        }
+    }
+
+    void pop_back() noexcept
+    {
+        assert(!empty());
+        offsets_.pop_back();
+        chars_.resize(offsets_.back());
+        if (size() % 64 == 0) {
+            presence_.pop_back();
+        } else {
+            presence_.back() &= ~(std::uint64_t(1) << (size() % 64));
+        }
+    }
+
+    void push(bool present)
+    {
+        if (chars_.size() >= std::numeric_limits<offset_type>::max()) {
+            start_value();
+#ifdef COMMATA_EXCEPTIONS_ENABLED
+            throw std::length_error(
+                "A column of commata::basic_columnar_stored_table "
+                "exceeded the limit of 32-bit offsets");
+#else
+            std::abort();
+#endif
+        }
+        const auto i = size();
+        offsets_.reserve(i + 2);                                // throw
+        presence_.reserve(i / 64 + 1);                          // throw
+        chars_.push_back(Ch());                                 // throw
+        offsets_.push_back(static_cast<offset_type>(chars_.size()));
+        if (i % 64 == 0) {
+            presence_.push_back(0);
+        }
+        if (present) {
+            presence_.back() |= std::uint64_t(1) << (i % 64);
+        }
+    }
+};
+
+template <class Ch, class Tr, class Allocator>
+void swap(basic_stored_column<Ch, Tr, Allocator>& left,
+          basic_stored_column<Ch, Tr, Allocator>& right) noexcept
+{
+    left.swap(right);
+}
+
+// Stores a table column by column so that scanning a few columns of a wide
+// table touches only their own arenas
+template <class Ch, class Tr = std::char_traits<Ch>,
+          class Allocator = std::allocator<Ch>>
+class basic_columnar_stored_table
+{
+public:
+    using allocator_type = Allocator;
+    using column_type    = basic_stored_column<Ch, Tr, Allocator>;
+    using char_type      = Ch;
+    using traits_type    = Tr;
+    using value_type     = typename column_type::value_type;
+    using size_type      = std::size_t;
+
+private:
+    using at_t = std::allocator_traits<Allocator>;
+    using cla_t = typename at_t::template rebind_alloc<column_type>;
+
+    std::vector<column_type, cla_t> columns_;
+    size_type size_;
+
+public:
+    explicit basic_columnar_stored_table(
+        const Allocator& alloc = Allocator()) :
+        columns_(cla_t(alloc)), size_(0)
+    {}
+
+    basic_columnar_stored_table(const basic_columnar_stored_table&) = default;
+    basic_columnar_stored_table(basic_columnar_stored_table&& other)
+        noexcept :
+        columns_(std::move(other.columns_)),
+        size_(std::exchange(other.size_, 0))
+    {}
+
+    ~basic_columnar_stored_table() = default;
+
+    basic_columnar_stored_table& operator=(
+        const basic_columnar_stored_table&) = default;
+
+    basic_columnar_stored_table& operator=(
+        basic_columnar_stored_table&& other)
+    {
+        columns_ = std::move(other.columns_);
+        size_ = std::exchange(other.size_, 0);
+        return *this;
+    }
+
+    allocator_type get_allocator() const noexcept
+    {
+        return allocator_type(columns_.get_allocator());
+    }
+
+    // Returns the number of the records
+    size_type size() const noexcept
+    {
+        return size_;
+    }
+
+    bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    size_type column_count() const noexcept
+    {
+        return columns_.size();
+    }
+
+    const column_type& column(size_type j) const noexcept
+    {
+        assert(j < column_count());
+        return columns_[j];
+    }
+
+    // Returns an empty value if the i-th record has no value in the j-th
+    // column
+    value_type operator()(size_type i, size_type j) const noexcept
+    {
+        assert(i < size());
+        return has_value(i, j) ? columns_[j][i] : value_type();
+    }
+
+    bool has_value(size_type i, size_type j) const noexcept
+    {
+        assert(i < size());
+        return (j < column_count())
+            && (i < columns_[j].size()) && columns_[j].has_value(i);
+    }
+
+    void pop_back() noexcept
+    {
+        assert(!empty());
+        --size_;
+        for (auto& c : columns_) {
+            if (c.size() > size_) {
+                c.pop_back();
+            }
+        }
+    }
+
+    void clear() noexcept
+    {
+        columns_.clear();
+        size_ = 0;
+    }
+
+    void shrink_to_fit()
+    {
+        columns_.shrink_to_fit();
+        for (auto& c : columns_) {
+            c.shrink_to_fit();
+        }
+    }
+
+    void swap(basic_columnar_stored_table& other) noexcept
+    {
+        columns_.swap(other.columns_);
+        std::swap(size_, other.size_);
+    }
+
+private:
+    template <class Ch2, class Tr2, class Allocator2>
+    friend class columnar_stored_table_builder;
+
+    // Makes every column from the j-th on have a value for each record
+    void pad(size_type j)
+    {
+        for (; j < columns_.size(); ++j) {
+            columns_[j].pad(size_);                             // throw
+        }
+    }
+
+    // Returns the j-th column, to which a value of the last record is to be
+    // pushed, adding columns if needed
+    column_type& secure_column(size_type j)
+    {
+        assert(!empty());
+        while (columns_.size() <= j) {
+            columns_.emplace_back(allocator_type(columns_.get_allocator()));
+                                                                // throw
+        }
+        auto& c = columns_[j];
+        c.pad(size_ - 1);                                       // throw
+        c.start_value();
+        return c;
+    }
+};
+
+template <class Ch, class Tr, class Allocator>
+void swap(basic_columnar_stored_table<Ch, Tr, Allocator>& left,
+          basic_columnar_stored_table<Ch, Tr, Allocator>& right) noexcept
+{
+    left.swap(right);
+}
+
+using columnar_stored_table  = basic_columnar_stored_table<char>;
+using wcolumnar_stored_table = basic_columnar_stored_table<wchar_t>;
+
+// Builds a basic_columnar_stored_table; values are copied into the arenas of
+// their columns as they are parsed, so this needs no buffer control
+template <class Ch, class Tr, class Allocator>
+class columnar_stored_table_builder
+{
+public:
+    using table_type = basic_columnar_stored_table<Ch, Tr, Allocator>;
+    using char_type = Ch;
+
+private:
+    using h_t = detail::stored::end_record_handler<table_type>;
+    using ph_t = typename std::allocator_traits<Allocator>::
+        template rebind_traits<h_t>::pointer;
+
+    table_type* table_;
+    typename table_type::column_type* column_;  // of the active value or null
+    std::size_t column_index_;
+    ph_t end_record_;
+
+public:
+    explicit columnar_stored_table_builder(table_type& table,
+                                           std::size_t max_record_num = 0) :
+        table_(std::addressof(table)), column_(nullptr), column_index_(0),
+        end_record_((max_record_num > 0) ?
+            allocate_construct(
+                [remaining = max_record_num](table_type&) mutable {
+                    return --remaining > 0;
+                }) : nullptr)
+    {}
+
+    template <class E,
+              std::enable_if_t<!std::is_integral_v<std::decay_t<E>>>*
+                  = nullptr>
+    columnar_stored_table_builder(table_type& table, E&& e) :
+        table_(std::addressof(table)), column_(nullptr), column_index_(0),
+        end_record_(allocate_construct(std::forward<E>(e)))
+    {}
+
+    columnar_stored_table_builder(columnar_stored_table_builder&& other)
+        noexcept :
+        table_(other.table_), column_(other.column_),
+        column_index_(other.column_index_),
+        end_record_(std::exchange(other.end_record_, nullptr))
+    {}
+
+    ~columnar_stored_table_builder()
+    {
+        if (end_record_) {
+            detail::destroy_deallocate_g_dynamic(
+                table_->get_allocator(), end_record_);
+        }
+    }
+
+private:
+    template <class T>
+    ph_t allocate_construct(T&& t)
+    {
+        using t_t = std::decay_t<T>;
+        using th_t = detail::stored::typed_end_record_handler<table_type, t_t>;
+        return detail::allocate_construct_g<th_t>(
+            table_->get_allocator(), std::forward<T>(t));
+    }
+
+public:
+    void start_record(const Ch* /*record_begin*/)
+    {
+        // The columns are padded at the end of the record, and each column
+        // which gets a value is padded by secure_column beforehand
+        ++table_->size_;
+        column_ = nullptr;
+        column_index_ = 0;
+    }
+
+    void update(const Ch* first, const Ch* last)
+    {
+        if (!column_) {
+            column_ = std::addressof(
+                table_->secure_column(column_index_));          // throw
+        }
+        column_->append(first, last);                           // throw
+    }
+
+    void finalize(const Ch* first, const Ch* last)
+    {
+        update(first, last);                                    // throw
+        column_->push_value();                                  // throw
+        column_ = nullptr;
+        ++column_index_;
+    }
+
+    bool end_record(const Ch* /*record_end*/)
+    {
+        // The columns before column_index_ have got values of this record
+        table_->pad(column_index_);                             // throw
+        return (!end_record_) || end_record_->on_end_record(*table_);
+    }
+};
+
+template <
+    stored_table_builder_option Options = stored_table_builder_option::none,
+    class Ch, class Tr, class Allocator, class... Args>
+[[nodiscard]]
+columnar_stored_table_builder<Ch, Tr, Allocator> make_stored_table_builder(
+    basic_columnar_stored_table<Ch, Tr, Allocator>& table, Args&&... args)
+{
+    static_assert(Options == stored_table_builder_option::none,
+        "commata::basic_columnar_stored_table cannot be built with "
+        "any stored_table_builder_option");
+    return columnar_stored_table_builder<Ch, Tr, Allocator>(
+        table, std::forward<Args>(args)...);
+}
+
+}
+
+#endif
@@ -0,0 +1,256 @@
+/**
+ * These codes are licensed under the Unlicense.
+ * http://unlicense.org
+ */
+
+#ifndef COMMATA_GUARD_5DF4C8A6_5AB3_4CD6_9D7F_CC18C2D8547F
+#define COMMATA_GUARD_5DF4C8A6_5AB3_4CD6_9D7F_CC18C2D8547F
+
+// CharInputs which decompress texts read from other CharInputs; each of them
+// is defined only if the header of the library it uses is available, and the
+// library must be linked to use it
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#if __has_include(<zlib.h>)
+#define COMMATA_GZIP_INPUT_AVAILABLE
+#include <zlib.h>
+#endif
+
+#include "detail/exceptions.hpp"
+#include "detail/typing_aid.hpp"
+
+namespace commata {
+
+class decompression_error : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
+namespace detail::decompress {
+
+[[noreturn]] inline void throw_error([[maybe_unused]] const char* what)
+{
+#ifdef COMMATA_EXCEPTIONS_ENABLED
+    throw decompression_error(what);
+#else
+    std::abort();
+#endif
+}
+
+// Buffer of compressed bytes read from Input
+template <class Input>
+class source
+{
+    static_assert(std::is_same_v<typename Input::char_type, char>);
+
+    Input in_;
+    std::unique_ptr<char[]> buffer_;
+    std::size_t buffer_size_;
+    bool eof_;
+    // Whether any byte has been read
+    bool started_;
+
+public:
+    static constexpr std::size_t default_buffer_size = 1U << 16;
+
+    source(Input&& in, std::size_t buffer_size) :
+        in_(std::move(in)),
+        buffer_size_((buffer_size == 0) ? default_buffer_size :
+                     std::max<std::size_t>(buffer_size, 2)),
+        eof_(false), started_(false)
+    {
+        buffer_.reset(new char[buffer_size_]);
+    }
+
+    const Input& base() const noexcept
+    {
+        return in_;
+    }
+
+    Input& base() noexcept
+    {
+        return in_;
+    }
+
+    bool eof() const noexcept
+    {
+        return eof_;
+    }
+
+    bool started() const noexcept
+    {
+        return started_;
+    }
+
+    // Moves rest_size bytes from rest, which have not been consumed yet, to
+    // the front of the buffer, reads compressed bytes after them and returns
+    // the range of them all, which is empty only at the end of the input
+    std::pair<const char*, std::size_t> read(
+        const char* rest = nullptr, std::size_t rest_size = 0)
+    {
+        if (rest_size > 0) {
+            std::char_traits<char>::move(buffer_.get(), rest, rest_size);
+        }
+        if (eof_ || (rest_size == buffer_size_)) {
+            return { buffer_.get(), rest_size };
+        }
+        using input_size_t = typename Input::size_type;
+        const auto n = static_cast<input_size_t>(std::min<std::common_type_t<
+                std::size_t, input_size_t>>(buffer_size_ - rest_size,
+                    std::numeric_limits<input_size_t>::max()));
+        std::size_t length;
+        do {
+            length = static_cast<std::size_t>(
+                in_(buffer_.get() + rest_size, n));
+            if constexpr (reports_eof_v<Input>) {
+                eof_ = in_.eof();
+            } else {
+                eof_ = (length < n);
+            }
+        } while ((length == 0) && !eof_);
+        started_ = started_ || (length > 0);
+        return { buffer_.get(), rest_size + length };
+    }
+};
+
+} // end detail::decompress
+
+#ifdef COMMATA_GZIP_INPUT_AVAILABLE
+
+// Decompresses a gzip or zlib stream read from Input, which can consist of
+// multiple members, directly into the buffer the reader gives; bytes after
+// a member which do not begin another one, such as zeros padding the
+// stream, are ignored as gzip does
+template <class Input>
+class gzip_input
+{
+    using source_t = detail::decompress::source<Input>;
+
+    // Held on the heap because zlib requires its address to be stable
+    std::unique_ptr<::z_stream> z_;
+    std::unique_ptr<source_t> src_;
+    bool ended_;
+
+public:
+    using base_type = Input;
+    using char_type = char;
+    using traits_type = std::char_traits<char>;
+    using size_type = std::size_t;
+
+    gzip_input() noexcept :
+        ended_(true)
+    {}
+
+    explicit gzip_input(Input in, std::size_t buffer_size = 0) :
+        z_(std::make_unique<::z_stream>()),
+        src_(std::make_unique<source_t>(std::move(in), buffer_size)),
+        ended_(false)
+    {
+        // 32 makes zlib detect gzip and zlib headers automatically
+        if (::inflateInit2(z_.get(), MAX_WBITS + 32) != Z_OK) {
+            detail::decompress::throw_error(
+                z_->msg ? z_->msg : "inflateInit2 failed");
+        }
+    }
+
+    gzip_input(gzip_input&& other) noexcept :
+        z_(std::move(other.z_)), src_(std::move(other.src_)),
+        ended_(std::exchange(other.ended_, true))
+    {}
+
+    ~gzip_input()
+    {
+        if (z_) {
+            ::inflateEnd(z_.get());
+        }
+    }
+
+    gzip_input& operator=(gzip_input&& other) noexcept
+    {
+        gzip_input(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    size_type operator()(char* out, size_type n)
+    {
+        size_type m = 0;
+        while ((m < n) && !ended_) {
+            if ((z_->avail_in == 0) && !refill()) {
+                if (src_->started()) {
+                    detail::decompress::throw_error(
+                        "Compressed stream is truncated");
+                }
+                ended_ = true;      // An empty input is an empty text
+                break;
+            }
+            const auto chunk = static_cast<::uInt>(std::min<size_type>(
+                n - m, std::numeric_limits<::uInt>::max()));
+            z_->next_out = reinterpret_cast<::Bytef*>(out + m);
+            z_->avail_out = chunk;
+            const int r = ::inflate(z_.get(), Z_NO_FLUSH);
+            m += chunk - z_->avail_out;
+            if (r == Z_STREAM_END) {
+                if (member_follows()) {
+                    ::inflateReset(z_.get());
+                } else {
+                    ended_ = true;
+                }
+            } else if ((r != Z_OK) && (r != Z_BUF_ERROR)) {
+                detail::decompress::throw_error(
+                    z_->msg ? z_->msg : "inflate failed");
+            }
+        }
+        return m;
+    }
+
+    void swap(gzip_input& other) noexcept
+    {
+        using std::swap;
+        swap(z_, other.z_);
+        swap(src_, other.src_);
+        swap(ended_, other.ended_);
+    }
+
+private:
+    bool refill()
+    {
+        const auto [p, length] = src_->read(
+            reinterpret_cast<const char*>(z_->next_in), z_->avail_in);
+        z_->next_in = reinterpret_cast<::Bytef*>(const_cast<char*>(p));
+        z_->avail_in = static_cast<::uInt>(length);
+        return length > 0;
+    }
+
+    // Returns whether the rest of the stream begins with the magic number
+    // of gzip members
+    bool member_follows()
+    {
+        while ((z_->avail_in < 2) && !src_->eof()) {
+            refill();
+        }
+        return (z_->avail_in >= 2)
+            && (z_->next_in[0] == 0x1f) && (z_->next_in[1] == 0x8b);
+    }
+};
+
+template <class Input>
+void swap(gzip_input<Input>& left, gzip_input<Input>& right) noexcept
+{
+    left.swap(right);
+}
+
+#endif
+
+}
+
+#endif
@@ -0,0 +1,213 @@
+/**
+ * These codes are licensed under the Unlicense.
+ * http://unlicense.org
+ */
+
+#ifndef COMMATA_GUARD_B74AE891_2BB3_4A81_A839_0C9CA2C00A7D
+#define COMMATA_GUARD_B74AE891_2BB3_4A81_A839_0C9CA2C00A7D
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "parse_csv.hpp"
+
+#include "detail/typing_aid.hpp"
+
+namespace commata {
+
+enum class concat_header : std::uint_fast8_t
+{
+    keep, drop_csv, drop_tsv
+};
+
+// Reads the texts of Inputs one after another as if they were one text;
+// a line terminator is supplied after a text which does not end with one,
+// and optionally the header records of the texts but the first are dropped;
+// Options are those of csv_source, whose csv_dialect, if any, tells the
+// quotation mark and the line break chars
+template <class Input, class... Options>
+class concat_input
+{
+public:
+    using base_type = Input;
+    using char_type = typename Input::char_type;
+    using traits_type = typename Input::traits_type;
+    using size_type = std::size_t;
+
+private:
+    using kc_t = detail::csv::key_chars_for_t<char_type, Options...>;
+
+    std::vector<Input> inputs_;
+    std::size_t current_;
+    concat_header header_;
+
+    // Whether any char has been read
+    bool started_;
+    // Whether the last char read is not a line terminator
+    bool in_line_;
+    // Whether an LF shall be supplied before the chars of the current input
+    bool lf_pending_;
+
+    // Whether the header record of the current input is being dropped
+    bool in_header_;
+    // Whether in a quoted field in the header record being dropped
+    bool quoted_;
+    // Whether a CR which terminates the header record has been dropped
+    bool after_cr_;
+
+public:
+    concat_input() noexcept(
+        std::is_nothrow_default_constructible_v<std::vector<Input>>) :
+        concat_input(std::vector<Input>())
+    {}
+
+    explicit concat_input(std::vector<Input> inputs,
+        concat_header header = concat_header::keep) noexcept :
+        inputs_(std::move(inputs)), current_(0), header_(header),
+        started_(false), in_line_(false), lf_pending_(false),
+        in_header_(false), quoted_(false), after_cr_(false)
+    {}
+
+    concat_input(const concat_input& other) = default;
+    concat_input(concat_input&& other) = default;
+    ~concat_input() = default;
+    concat_input& operator=(const concat_input& other) = default;
+    concat_input& operator=(concat_input&& other) = default;
+
+    const std::vector<Input>& base() const noexcept
+    {
+        return inputs_;
+    }
+
+    std::vector<Input>& base() noexcept
+    {
+        return inputs_;
+    }
+
+    size_type operator()(char_type* out, size_type n)
+    {
+        using input_size_t = typename Input::size_type;
+        size_type m = 0;
+        while ((m < n) && (current_ < inputs_.size())) {
+            if (lf_pending_) {
+                traits_type::assign(out[m], kc_t::lf_c);
+                ++m;
+                lf_pending_ = false;
+                in_line_ = false;
+                continue;
+            }
+
+            auto& in = inputs_[current_];
+            const auto r = static_cast<input_size_t>(std::min<
+                std::common_type_t<size_type, input_size_t>>(
+                    n - m, std::numeric_limits<input_size_t>::max()));
+            const auto length = static_cast<size_type>(in(out + m, r));
+            bool eof;
+            if constexpr (detail::reports_eof_v<Input>) {
+                eof = in.eof();
+            } else {
+                eof = (length < r);
+            }
+
+            const auto first = out + m;
+            auto last = first + length;
+            if (in_header_) {
+                const auto p = skip_header(first, last);
+                if (p != first) {
+                    traits_type::move(first, p, last - p);
+                    last -= p - first;
+                }
+            }
+            if (first != last) {
+                const auto c = traits_type::to_int_type(*(last - 1));
+                in_line_ =
+                    !traits_type::eq_int_type(
+                        c, traits_type::to_int_type(kc_t::lf_c))
+                 && !traits_type::eq_int_type(
+                        c, traits_type::to_int_type(kc_t::cr_c));
+                started_ = true;
+                m += static_cast<size_type>(last - first);
+            }
+
+            if (eof) {
+                next();
+            }
+        }
+        return m;
+    }
+
+    void swap(concat_input& other)
+        noexcept(std::is_nothrow_swappable_v<std::vector<Input>>)
+    {
+        using std::swap;
+        swap(inputs_, other.inputs_);
+        swap(current_, other.current_);
+        swap(header_, other.header_);
+        swap(started_, other.started_);
+        swap(in_line_, other.in_line_);
+        swap(lf_pending_, other.lf_pending_);
+        swap(in_header_, other.in_header_);
+        swap(quoted_, other.quoted_);
+        swap(after_cr_, other.after_cr_);
+    }
+
+private:
+    void next() noexcept
+    {
+        ++current_;
+        if (current_ < inputs_.size()) {
+            lf_pending_ = in_line_;
+            // Texts before the first nonempty one have no header records to
+            // compete with
+            in_header_ = started_ && (header_ != concat_header::keep);
+            quoted_ = false;
+            after_cr_ = false;
+        }
+    }
+
+    // Returns the pointer to the first char in [first, last) which does not
+    // belong to the header record
+    char_type* skip_header(char_type* first, char_type* last) noexcept
+    {
+        const auto is = [](char_type c, char_type d) {
+            return traits_type::eq(c, d);
+        };
+        for (; first != last; ++first) {
+            const auto c = *first;
+            if (after_cr_) {
+                in_header_ = false;
+                return is(c, kc_t::lf_c) ? first + 1 : first;
+            } else if (quoted_) {
+                // A doubled DQUOTE leaves and enters quotes at once
+                quoted_ = !is(c, kc_t::dquote_c);
+            } else if (is(c, kc_t::lf_c)) {
+                in_header_ = false;
+                return first + 1;
+            } else if (is(c, kc_t::cr_c)) {
+                after_cr_ = true;
+            } else if (is(c, kc_t::dquote_c)
+                    && (header_ == concat_header::drop_csv)) {
+                quoted_ = true;
+            }
+        }
+        return last;
+    }
+};
+
+template <class Input, class... Options>
+auto swap(concat_input<Input, Options...>& left,
+          concat_input<Input, Options...>& right)
+    noexcept(noexcept(left.swap(right)))
+ -> std::enable_if_t<std::is_swappable_v<Input>>
+{
+    left.swap(right);
+}
+
+}
+
+#endif
@@ -6,12 +6,24 @@
 #ifndef COMMATA_GUARD_9AF7CB02_5702_4A95_AA5E_781F44203C7F
 #define COMMATA_GUARD_9AF7CB02_5702_4A95_AA5E_781F44203C7F
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdlib>
+#include <initializer_list>
+#include <iterator>
+#include <string>
 #include <string_view>
 #include <type_traits>
+#include <utility>
 
+#include "../encoding_error.hpp"
+#include "../parse_error.hpp"
 #include "../parse_result.hpp"
 
+#include "exceptions.hpp"
+#include "typing_aid.hpp"
+#include "utf8_validation.hpp"
+
 namespace commata::detail {
 
 template <class Input, class Handler, class State, class D>
@@ -41,6 +53,20 @@ public:
         nonconst_direct || !reads_direct::value,
         huc_t, hc_t>;
 
+private:
+    // Whether the handler can abort parsing by returning false
+    static constexpr bool abortable =
+        !std::is_void_v<decltype(std::declval<Handler&>().start_record(
+            std::declval<buffer_char_t*>()))>
+     || !std::is_void_v<decltype(std::declval<Handler&>().update(
+            std::declval<buffer_char_t*>(), std::declval<buffer_char_t*>()))>
+     || !std::is_void_v<decltype(std::declval<Handler&>().finalize(
+            std::declval<buffer_char_t*>(), std::declval<buffer_char_t*>()))>
+     || !std::is_void_v<decltype(std::declval<Handler&>().end_record(
+            std::declval<buffer_char_t*>()))>
+     || !std::is_void_v<decltype(std::declval<Handler&>().empty_physical_line(
+            std::declval<buffer_char_t*>()))>;
+
 private:
     // Reading position
     buffer_char_t* p_;
@@ -63,13 +89,33 @@ private:
     State s_;
     bool record_started_;
     bool eof_reached_;
-
-private:
-    // To make control flows clearer, we adopt exceptions. Sigh...
-    struct parse_aborted
-    {
-        buffer_char_t* pos;
-    };
+    // Set when the handler has returned false or a malformation has been
+    // reported to failure_; then no more handler calls are made and
+    // invoke_body returns as soon as the current step finishes
+    bool halted_;
+
+    // Where malformations are reported instead of throwing parse_error
+    parse_failure* failure_;
+
+    // Used only when D::validates_utf8 is true; utf8_invalid_ points the
+    // first invalid byte in the current buffer, if any
+    utf8_validator utf8_validator_;
+    buffer_char_t* utf8_invalid_;
+
+    // Used only when D::validates_utf8 is true; bom_held_ is the number of
+    // the leading bytes of the text which agree with the BOM and have been
+    // held back because their buffer ended, or bom_settled once the BOM has
+    // been skipped or has turned out to be absent. If the held bytes are not
+    // the BOM after all, they are parsed on bom_chars_ as a buffer of their
+    // own before the direct read buffer which follows them, which is kept in
+    // deferred_ in the meantime
+    std::size_t bom_held_;
+    huc_t bom_chars_[3];
+    bool deferring_;
+    bool deferred_eof_;
+    std::pair<buffer_char_t*, std::size_t> deferred_;
+
+    static constexpr std::size_t bom_settled = static_cast<std::size_t>(-1);
 
 public:
     template <class InputR, class HandlerR,
@@ -86,7 +132,10 @@ public:
         physical_line_chars_passed_away_(0),
         in_(std::forward<InputR>(in)), buffer_(nullptr), buffer_last_(nullptr),
         buffer_offset_(0),
-        s_(D::first_state), record_started_(false), eof_reached_(false)
+        s_(D::first_state), record_started_(false), eof_reached_(false),
+        halted_(false), failure_(nullptr), utf8_invalid_(nullptr),
+        bom_held_(0), bom_chars_(), deferring_(false), deferred_eof_(false),
+        deferred_(nullptr, 0)
     {}
 
     base_parser(base_parser&& other) noexcept(
@@ -103,8 +152,24 @@ public:
         buffer_last_(other.buffer_last_),
         buffer_offset_(other.buffer_offset_),
         s_(other.s_), record_started_(other.record_started_),
-        eof_reached_(other.eof_reached_)
-    {}
+        eof_reached_(other.eof_reached_), halted_(other.halted_),
+        failure_(nullptr), utf8_validator_(other.utf8_validator_),
+        utf8_invalid_(other.utf8_invalid_), bom_held_(other.bom_held_),
+        bom_chars_(), deferring_(other.deferring_),
+        deferred_eof_(other.deferred_eof_), deferred_(other.deferred_)
+    {
+        std::copy(std::begin(other.bom_chars_), std::end(other.bom_chars_),
+            bom_chars_);
+        if (buffer_ == other.bom_chars_) {
+            // The held BOM bytes are being parsed on other.bom_chars_ as a
+            // buffer, into which the pointers must follow them
+            for (auto p : { &p_, &first_, &last_,
+                            &physical_line_or_buffer_begin_,
+                            &buffer_, &buffer_last_, &utf8_invalid_ }) {
+                rebase_on_bom_chars(*p, other.bom_chars_);
+            }
+        }
+    }
 
     ~base_parser()
     {
@@ -119,19 +184,60 @@ public:
 
     parse_result operator()()
     {
+        failure_ = nullptr;
+        return invoke<false>();
+    }
+
+    // Reports malformations of the text to failure instead of throwing
+    // parse_error
+    parse_result operator()(parse_failure& failure)
+    {
+        failure = parse_failure();
+        failure_ = &failure;
+        return invoke<true>();
+    }
+
+private:
+    template <bool Failable>
+    parse_result invoke()
+    {
+#ifdef COMMATA_EXCEPTIONS_ENABLED
         if constexpr (has_handle_exception_v<Handler>) {
             try {
-                return invoke_impl();
+                return invoke_impl<Failable>();
             } catch (...) {
                 f_.handle_exception();
                 throw;
             }
         } else {
-            return invoke_impl();
+            return invoke_impl<Failable>();
         }
+#else
+        return invoke_impl<Failable>();
+#endif
+    }
+
+    template <bool Failable>
+    parse_result invoke_impl()
+    {
+#ifdef COMMATA_EXCEPTIONS_ENABLED
+        try {
+            return invoke_body<Failable>();
+        } catch (text_error& e) {
+            e.set_physical_position(
+                physical_line_index_, get_physical_column_index());
+            throw;
+        } catch (...) {
+            text_error e;
+            e.set_physical_position(
+                physical_line_index_, get_physical_column_index());
+            std::throw_with_nested(std::move(e));
+        }
+#else
+        return invoke_body<Failable>();
+#endif
     }
 
-private:
 #ifdef _MSC_VER
 #pragma warning(push)
 #pragma warning(disable:4102)
@@ -139,8 +245,9 @@ private:
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-label"
 #endif
-    parse_result invoke_impl()
-    try {
+    template <bool Failable>
+    parse_result invoke_body()
+    {
         if constexpr (has_yield_location_v<Handler>) {
             switch (f_.yield_location()) {
             case 0:
@@ -162,11 +269,18 @@ private:
                 if (buffer_) {
                     buffer_offset_ += buffer_last_ - buffer_;
                 }
-                const auto [buffer_size, loaded_size] = arrange_buffer();
+                auto [buffer_size, loaded_size] = arrange_buffer();
                 p_ = buffer_;
                 physical_line_or_buffer_begin_ = buffer_;
                 buffer_last_ = buffer_ + loaded_size;
+                if constexpr (D::validates_utf8) {
+                    if (bom_held_ != bom_settled) {
+                        skip_bom(buffer_size);
+                    }
+                    validate_utf8();
+                }
                 f_.start_buffer(buffer_, buffer_ + buffer_size);
+                static_cast<D*>(this)->buffer_arranged();
             }
 
             set_first_last();
@@ -175,6 +289,9 @@ private:
                 D::step(s_, [this](const auto& h) {
                     h.normal(*static_cast<D*>(this), p_, buffer_last_);
                 });
+                if (is_halted<Failable>()) {
+                    return halt();
+                }
 
                 if constexpr (has_yield_v<Handler>) {
                     if (f_.yield(1)) {
@@ -184,18 +301,33 @@ private:
 yield_1:
                 ++p_;
             }
+            if constexpr (D::validates_utf8) {
+                if (utf8_invalid_) {
+                    p_ = utf8_invalid_;
+                    fail_invalid_utf8();
+                    return halt();
+                } else if (eof_reached_ && !utf8_validator_.complete()) {
+                    fail_invalid_utf8();
+                    return halt();
+                }
+            }
             D::step(s_, [this](const auto& h) { h.underflow(*this); });
-            if (eof_reached_) {
+            if (eof_reached_ && !is_halted<Failable>()) {
                 set_first_last();
                 D::step(s_, [this](const auto& h) { h.eof(*this); });
-                if (record_started_) {
+                if (record_started_ && !is_halted<Failable>()) {
                     end_record();
                 }
             }
+            if (is_halted<Failable>()) {
+                return halt();
+            }
 
             f_.end_buffer(buffer_last_);
             if constexpr (has_yield_v<Handler>) {
-                if (f_.yield(2)) {
+                // The deferred buffer must be parsed before the input is
+                // told to read the next one
+                if (!deferring_ && f_.yield(2)) {
                     return parse_result(true, get_parse_point());
                 }
             }
@@ -215,17 +347,6 @@ yield_2:
         }
 yield_end:
         return parse_result(true, get_parse_point());
-    } catch (const parse_aborted& e) {
-        return parse_result(false, buffer_offset_ + (e.pos - buffer_));
-    } catch (text_error& e) {
-        e.set_physical_position(
-            physical_line_index_, get_physical_column_index());
-        throw;
-    } catch (...) {
-        text_error e;
-        e.set_physical_position(
-            physical_line_index_, get_physical_column_index());
-        std::throw_with_nested(std::move(e));
     }
 #ifdef _MSC_VER
 #pragma warning(pop)
@@ -233,6 +354,11 @@ yield_end:
 #pragma GCC diagnostic pop
 #endif
 
+    parse_result halt() noexcept
+    {
+        return parse_result(false, get_parse_point());
+    }
+
 public:
     std::size_t get_parse_point() const noexcept
     {
@@ -250,6 +376,99 @@ private:
                     + physical_line_chars_passed_away_;
     }
 
+    // Makes p point the counterpart in bom_chars_ of the char in old_bom_chars
+    // which it points, if any
+    void rebase_on_bom_chars(buffer_char_t*& p, const huc_t* old_bom_chars)
+        noexcept
+    {
+        for (std::size_t i = 0; i <= std::size(bom_chars_); ++i) {
+            if (p == old_bom_chars + i) {
+                p = bom_chars_ + i;
+                return;
+            }
+        }
+    }
+
+    // Skips the BOM at the beginning of the text, which may lie across
+    // buffers; the bytes at the end of a buffer which may begin the BOM are
+    // held back until the following bytes tell whether they are the BOM
+    void skip_bom(std::size_t& buffer_size) noexcept
+    {
+        static constexpr unsigned char bom[] = { 0xEF, 0xBB, 0xBF };
+        const auto held = bom_held_;
+        while ((bom_held_ < 3) && (p_ < buffer_last_)
+            && (static_cast<unsigned char>(*p_) == bom[bom_held_])) {
+            ++p_;
+            ++bom_held_;
+        }
+        if (bom_held_ == 3) {
+            bom_held_ = bom_settled;
+        } else if ((p_ == buffer_last_) && !eof_reached_
+                && (reads_direct::value || (buffer_size >= 3))) {
+            // Indirect reads prepend the held bytes to the next buffer, which
+            // therefore shall have room for more
+            physical_line_or_buffer_begin_ = p_;
+            return;
+        } else {
+            bom_held_ = bom_settled;
+            p_ = buffer_;
+            if constexpr (reads_direct::value) {
+                if (held > 0) {
+                    // The held bytes go first on a buffer of their own
+                    deferring_ = true;
+                    deferred_ = { buffer_,
+                        static_cast<std::size_t>(buffer_last_ - buffer_) };
+                    deferred_eof_ = eof_reached_;
+                    eof_reached_ = false;
+                    for (std::size_t i = 0; i < held; ++i) {
+                        bom_chars_[i] = static_cast<huc_t>(bom[i]);
+                    }
+                    buffer_ = bom_chars_;
+                    buffer_last_ = buffer_ + held;
+                    buffer_size = held;
+                    buffer_offset_ -= held;
+                    p_ = buffer_;
+                }
+            }
+        }
+        physical_line_or_buffer_begin_ = p_;
+    }
+
+    // Cuts the buffer short around the first byte which makes the text
+    // invalid, so that the state machine stops there having counted the
+    // physical position of it
+    void validate_utf8() noexcept
+    {
+        const auto invalid = utf8_validator_(p_, buffer_last_);
+        if (invalid != buffer_last_) {
+            utf8_invalid_ = invalid;
+            // A non-ASCII byte is an ordinary char to the state machine,
+            // which may start a new physical line on it; an ASCII one, which
+            // may be a key char, follows an incomplete sequence in the same
+            // line and must not reach the state machine
+            buffer_last_ =
+                (static_cast<unsigned char>(*invalid) < 0x80) ?
+                invalid : (invalid + 1);
+        }
+    }
+
+    // Reports the invalid UTF-8 sequence on p_ to failure_ if any, or throws
+    // encoding_error
+    void fail_invalid_utf8()
+    {
+        if (failure_) {
+            fail(parse_errc::invalid_utf8_sequence);
+        } else {
+#ifdef COMMATA_EXCEPTIONS_ENABLED
+            using namespace std::string_literals;
+            throw encoding_error("Invalid UTF-8 sequence at byte offset "s
+                               + std::to_string(get_parse_point()));
+#else
+            std::abort();
+#endif
+        }
+    }
+
     std::pair<std::size_t, std::size_t> arrange_buffer()
     {
         if constexpr (reads_direct::value) {
@@ -262,14 +481,31 @@ private:
 
     std::size_t arrange_buffer_direct()
     {
+        if (deferring_) {
+            deferring_ = false;
+            eof_reached_ = deferred_eof_;
+            buffer_ = deferred_.first;
+            return deferred_.second;
+        }
+
         using input_size_t = typename Input::size_type;
         using min_t = std::common_type_t<std::size_t, input_size_t>;
         constexpr auto x = std::min<min_t>(
             std::numeric_limits<input_size_t>::max(),
             std::numeric_limits<std::size_t>::max());
         min_t loaded_size;
-        std::tie(buffer_, loaded_size) = in_(static_cast<input_size_t>(x));
-        eof_reached_ = (loaded_size < x);
+        if constexpr (reports_eof_v<Input>) {
+            // The text may come in segments of any length, each of which
+            // becomes a buffer, so only empty ones are skipped
+            do {
+                std::tie(buffer_, loaded_size) =
+                    in_(static_cast<input_size_t>(x));
+                eof_reached_ = in_.eof();
+            } while ((loaded_size == 0) && !eof_reached_);
+        } else {
+            std::tie(buffer_, loaded_size) = in_(static_cast<input_size_t>(x));
+            eof_reached_ = (loaded_size < x);
+        }
         return static_cast<std::size_t>(loaded_size);
     }
 
@@ -279,11 +515,38 @@ private:
         std::size_t buffer_size;
         std::tie(buffer_, buffer_size) = f_.get_buffer();   // throw
         if (buffer_size < 1) {
+#ifdef COMMATA_EXCEPTIONS_ENABLED
             throw std::out_of_range(
                 "Specified buffer length is shorter than one"s);
+#else
+            std::abort();
+#endif
+        }
+
+        // The bytes of the BOM held back at the end of the previous buffer
+        // are read again
+        std::size_t held = 0;
+        if constexpr (D::validates_utf8) {
+            if ((bom_held_ != bom_settled) && (bom_held_ > 0)) {
+                if (buffer_size <= bom_held_) {
+#ifdef COMMATA_EXCEPTIONS_ENABLED
+                    throw std::out_of_range(
+                        "Specified buffer length is too short to hold "
+                        "the BOM"s);
+#else
+                    std::abort();
+#endif
+                }
+                held = std::exchange(bom_held_, 0);
+                static constexpr unsigned char bom[] = { 0xEF, 0xBB };
+                for (std::size_t i = 0; i < held; ++i) {
+                    buffer_[i] = static_cast<huc_t>(bom[i]);
+                }
+                buffer_offset_ -= held;
+            }
         }
 
-        std::size_t loaded_size = 0;
+        std::size_t loaded_size = held;
         do {
             using input_size_t = typename Input::size_type;
             using min_t = std::common_type_t<std::size_t, input_size_t>;
@@ -293,7 +556,14 @@ private:
             const auto length = static_cast<std::size_t>(
                 in_(buffer_ + loaded_size, static_cast<input_size_t>(n)));
             loaded_size += length;
-            if (length < n) {
+            if constexpr (reports_eof_v<Input>) {
+                // A short read does not mean the end of the text, so the
+                // chars read so far are handed to the state machine at once
+                eof_reached_ = in_.eof();
+                if (eof_reached_ || (loaded_size > held)) {
+                    break;
+                }
+            } else if (length < n) {
                 eof_reached_ = true;
                 break;
             }
@@ -303,6 +573,24 @@ private:
     }
 
 public:
+    // Called when a new buffer has been arranged; derived classes which keep
+    // some data on the buffer hide this to discard them
+    void buffer_arranged() noexcept
+    {}
+
+    // Derived classes which hide this with true, whose chars shall be one
+    // byte long, have the text validated as UTF-8 buffer by buffer before
+    // the state machine walks through it, and have the BOM at its beginning
+    // skipped
+    static constexpr bool validates_utf8 = false;
+
+    // Makes the parser take its text for a part of a larger text other than
+    // its beginning, where no BOM is skipped
+    void disable_bom_skip() noexcept
+    {
+        bom_held_ = bom_settled;
+    }
+
     // Makes p_ become the first char of the new line
     void new_physical_line() noexcept
     {
@@ -333,6 +621,12 @@ public:
         last_ = p_ + 1;
     }
 
+    // Makes last_ point p_; used after p_ has skipped a run of ordinary chars
+    void set_last() noexcept
+    {
+        last_ = p_;
+    }
+
     void update()
     {
         if (!record_started_) {
@@ -385,13 +679,47 @@ public:
         });
     }
 
+    // Reports a malformation of the text
+    void fail(parse_errc ec)
+    {
+        if (failure_) {
+            *failure_ = parse_failure(make_error_code(ec),
+                physical_line_index_, get_physical_column_index());
+            halted_ = true;
+        } else {
+#ifdef COMMATA_EXCEPTIONS_ENABLED
+            throw parse_error(detail::get_parse_errc_message(ec));
+#else
+            std::abort();
+#endif
+        }
+    }
+
     template <class F>
     inline void do_or_abort(F f)
     {
+        if constexpr (abortable) {
+            if (halted_) {
+                // Once aborted, the rest of the current step must not reach
+                // the handler
+                return;
+            }
+        }
         if constexpr (std::is_void_v<decltype(f())>) {
             f();
         } else if (!f()) {
-            throw parse_aborted{p_};
+            halted_ = true;
+        }
+    }
+
+private:
+    template <bool Failable>
+    bool is_halted() const noexcept
+    {
+        if constexpr (abortable || Failable) {
+            return halted_;
+        } else {
+            return false;
         }
     }
 };
@@ -0,0 +1,270 @@
+/**
+ * These codes are licensed under the Unlicense.
+ * http://unlicense.org
+ */
+
+#ifndef COMMATA_GUARD_97F9871C_81E5_433D_A384_59C3F6B7560B
+#define COMMATA_GUARD_97F9871C_81E5_433D_A384_59C3F6B7560B
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#define COMMATA_SIMD_AVX2
+#define COMMATA_SIMD_SSE2
+#define COMMATA_SIMD_AVX2_TARGET
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) \
+   || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define COMMATA_SIMD_SSE2
+#if (defined(__GNUC__) || defined(__clang__)) \
+ && (defined(__x86_64__) || defined(__i386__))
+// AVX2 is not enabled at compile time, but it can be used if the running
+// processor is found to support it
+#define COMMATA_SIMD_AVX2_DISPATCH
+#define COMMATA_SIMD_AVX2_TARGET __attribute__((target("avx2")))
+#include <immintrin.h>
+#else
+#include <emmintrin.h>
+#endif
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace commata::detail {
+
+namespace simd {
+
+inline int countr_zero(unsigned x) noexcept
+{
+#ifdef _MSC_VER
+    unsigned long i;
+    _BitScanForward(&i, x);
+    return static_cast<int>(i);
+#else
+    return __builtin_ctz(x);
+#endif
+}
+
+inline int countr_zero(std::uint64_t x) noexcept
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long i;
+    _BitScanForward64(&i, x);
+    return static_cast<int>(i);
+#elif defined(_MSC_VER)
+    const auto low = static_cast<unsigned>(x);
+    return (low != 0) ? countr_zero(low) :
+        (32 + countr_zero(static_cast<unsigned>(x >> 32)));
+#else
+    return __builtin_ctzll(x);
+#endif
+}
+
+template <class Ch>
+constexpr bool is_vectorizable_v = std::is_integral_v<Ch>
+ && ((sizeof(Ch) == 1) || (sizeof(Ch) == 2) || (sizeof(Ch) == 4));
+
+#ifdef COMMATA_SIMD_SSE2
+
+template <class Ch>
+__m128i broadcast_128(Ch c) noexcept
+{
+    if constexpr (sizeof(Ch) == 1) {
+        return _mm_set1_epi8(static_cast<char>(c));
+    } else if constexpr (sizeof(Ch) == 2) {
+        return _mm_set1_epi16(static_cast<short>(c));
+    } else {
+        return _mm_set1_epi32(static_cast<int>(c));
+    }
+}
+
+template <class Ch>
+__m128i equal_128(__m128i a, __m128i b) noexcept
+{
+    if constexpr (sizeof(Ch) == 1) {
+        return _mm_cmpeq_epi8(a, b);
+    } else if constexpr (sizeof(Ch) == 2) {
+        return _mm_cmpeq_epi16(a, b);
+    } else {
+        return _mm_cmpeq_epi32(a, b);
+    }
+}
+
+// Skips blocks of 16 bytes which contain none of Cs and then returns the
+// first position of the block which contains any of them, or the position
+// from which less than 16 bytes remain
+template <class Ch, Ch... Cs, class C>
+C* find_any_of_sse2(C* first, C* last) noexcept
+{
+    constexpr std::ptrdiff_t n = 16 / sizeof(Ch);
+    while (last - first >= n) {
+        const __m128i v =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        __m128i m = _mm_setzero_si128();
+        ((m = _mm_or_si128(m, equal_128<Ch>(v, broadcast_128(Cs)))), ...);
+        const auto mask = static_cast<unsigned>(_mm_movemask_epi8(m));
+        if (mask != 0) {
+            return first + countr_zero(mask) / sizeof(Ch);
+        }
+        first += n;
+    }
+    return first;
+}
+
+// Returns a vector of 16 bytes whose i-th byte is 0xff if p[i] is equal to
+// any of Cs and 0x00 otherwise
+template <class Ch, Ch... Cs, class C>
+__m128i equal_any_of_16(C* p) noexcept
+{
+    const auto equal_any_of = [](const C* q) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(q));
+        __m128i m = _mm_setzero_si128();
+        ((m = _mm_or_si128(m, equal_128<Ch>(v, broadcast_128(Cs)))), ...);
+        return m;
+    };
+    if constexpr (sizeof(Ch) == 1) {
+        return equal_any_of(p);
+    } else if constexpr (sizeof(Ch) == 2) {
+        return _mm_packs_epi16(equal_any_of(p), equal_any_of(p + 8));
+    } else {
+        return _mm_packs_epi16(
+            _mm_packs_epi32(equal_any_of(p), equal_any_of(p + 4)),
+            _mm_packs_epi32(equal_any_of(p + 8), equal_any_of(p + 12)));
+    }
+}
+
+template <class Ch, Ch... Cs, class C>
+std::uint64_t mask_any_of_64_sse2(C* p) noexcept
+{
+    std::uint64_t mask = 0;
+    for (int i = 0; i < 4; ++i) {
+        const auto m = static_cast<unsigned>(
+            _mm_movemask_epi8(equal_any_of_16<Ch, Cs...>(p + 16 * i)));
+        mask |= static_cast<std::uint64_t>(m) << (16 * i);
+    }
+    return mask;
+}
+
+#endif
+
+#if defined(COMMATA_SIMD_AVX2) || defined(COMMATA_SIMD_AVX2_DISPATCH)
+
+template <class Ch>
+COMMATA_SIMD_AVX2_TARGET __m256i broadcast_256(Ch c) noexcept
+{
+    if constexpr (sizeof(Ch) == 1) {
+        return _mm256_set1_epi8(static_cast<char>(c));
+    } else if constexpr (sizeof(Ch) == 2) {
+        return _mm256_set1_epi16(static_cast<short>(c));
+    } else {
+        return _mm256_set1_epi32(static_cast<int>(c));
+    }
+}
+
+template <class Ch>
+COMMATA_SIMD_AVX2_TARGET __m256i equal_256(__m256i a, __m256i b) noexcept
+{
+    if constexpr (sizeof(Ch) == 1) {
+        return _mm256_cmpeq_epi8(a, b);
+    } else if constexpr (sizeof(Ch) == 2) {
+        return _mm256_cmpeq_epi16(a, b);
+    } else {
+        return _mm256_cmpeq_epi32(a, b);
+    }
+}
+
+// The same as find_any_of_sse2 except that this function works on blocks of
+// 32 bytes
+template <class Ch, Ch... Cs, class C>
+COMMATA_SIMD_AVX2_TARGET C* find_any_of_avx2(C* first, C* last) noexcept
+{
+    constexpr std::ptrdiff_t n = 32 / sizeof(Ch);
+    while (last - first >= n) {
+        const __m256i v =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+        __m256i m = _mm256_setzero_si256();
+        ((m = _mm256_or_si256(m, equal_256<Ch>(v, broadcast_256(Cs)))), ...);
+        const auto mask = static_cast<unsigned>(_mm256_movemask_epi8(m));
+        if (mask != 0) {
+            return first + countr_zero(mask) / sizeof(Ch);
+        }
+        first += n;
+    }
+    return first;
+}
+
+#endif
+
+#ifdef COMMATA_SIMD_AVX2_DISPATCH
+
+inline bool is_avx2_available() noexcept
+{
+    static const bool available = __builtin_cpu_supports("avx2");
+    return available;
+}
+
+#endif
+
+} // end simd
+
+// Returns the first position in [first, last) whose character is equal to
+// any of Cs, or last if no such position exists
+template <class Ch, Ch... Cs, class C>
+C* find_any_of(C* first, C* last) noexcept
+{
+    static_assert(std::is_same_v<Ch, std::remove_const_t<C>>);
+
+    if constexpr (simd::is_vectorizable_v<Ch>) {
+#if defined(COMMATA_SIMD_AVX2)
+        first = simd::find_any_of_avx2<Ch, Cs...>(first, last);
+#elif defined(COMMATA_SIMD_AVX2_DISPATCH)
+        if (simd::is_avx2_available()) {
+            first = simd::find_any_of_avx2<Ch, Cs...>(first, last);
+        }
+#endif
+#ifdef COMMATA_SIMD_SSE2
+        first = simd::find_any_of_sse2<Ch, Cs...>(first, last);
+#endif
+    }
+
+    for (; first != last; ++first) {
+        const Ch c = *first;
+        if (((c == Cs) || ...)) {
+            break;
+        }
+    }
+    return first;
+}
+
+// Returns a bit mask whose i-th bit is set if and only if p[i] is equal to
+// any of Cs for each i in [0, n), where n shall not be greater than 64
+template <class Ch, Ch... Cs, class C>
+std::uint64_t mask_any_of(C* p, std::size_t n) noexcept
+{
+    static_assert(std::is_same_v<Ch, std::remove_const_t<C>>);
+    assert(n <= 64);
+
+#ifdef COMMATA_SIMD_SSE2
+    if constexpr (simd::is_vectorizable_v<Ch>) {
+        if (n == 64) {
+            return simd::mask_any_of_64_sse2<Ch, Cs...>(p);
+        }
+    }
+#endif
+
+    std::uint64_t mask = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const Ch c = p[i];
+        mask |= static_cast<std::uint64_t>(((c == Cs) || ...)) << i;
+    }
+    return mask;
+}
+
+}
+
+#endif
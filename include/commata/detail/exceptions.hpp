@@ -0,0 +1,14 @@
+/**
+ * These codes are licensed under the Unlicense.
+ * http://unlicense.org
+ */
+
+#ifndef COMMATA_GUARD_974F8ED1_3C56_46EB_AB32_144BC9A91D91
+#define COMMATA_GUARD_974F8ED1_3C56_46EB_AB32_144BC9A91D91
+
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) \
+ || (defined(_MSC_VER) && defined(_CPPUNWIND))
+#define COMMATA_EXCEPTIONS_ENABLED
+#endif
+
+#endif
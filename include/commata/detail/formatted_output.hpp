@@ -10,6 +10,8 @@
 #include <ostream>
 #include <streambuf>
 
+#include "exceptions.hpp"
+
 namespace commata::detail {
 
 template <class Ch, class Tr, class F>
@@ -19,25 +21,28 @@ std::basic_ostream<Ch, Tr>& formatted_output(
     const typename std::basic_ostream<Ch, Tr>::sentry s(os);    // throw
     if (s) {
         bool sets_failbit = true;
-        try  {
-            const auto pad = [&os, n, w = os.width()] {
-                if (w > n) {
-                    const auto sb = os.rdbuf();
-                    const auto f = os.fill();
-                    for (std::streamsize i = 0, ie = w - n; i < ie; ++i) {
-                        if (sb->sputc(f) == Tr::eof()) {
-                            return false;
-                        }
+        const auto pad = [&os, n, w = os.width()] {
+            if (w > n) {
+                const auto sb = os.rdbuf();
+                const auto f = os.fill();
+                for (std::streamsize i = 0, ie = w - n; i < ie; ++i) {
+                    if (sb->sputc(f) == Tr::eof()) {
+                        return false;
                     }
                 }
-                return true;
-            };
-            const auto put = [&os, &put_obj] {
-                return put_obj(os.rdbuf());
-            };
+            }
+            return true;
+        };
+        const auto put = [&os, &put_obj] {
+            return put_obj(os.rdbuf());
+        };
+#ifdef COMMATA_EXCEPTIONS_ENABLED
+        try  {
+#endif
             sets_failbit = !(((os.flags() & std::ios_base::adjustfield)
                            == std::ios_base::left) ?
                 put() && pad() : pad() && put());               // throw
+#ifdef COMMATA_EXCEPTIONS_ENABLED
         } catch (...) {
             // Set badbit without causing an std::ios::failure to be thrown
             // (C++17 30.7.5.2.1)
@@ -52,6 +57,7 @@ std::basic_ostream<Ch, Tr>& formatted_output(
             }
             sets_failbit = false;
         }
+#endif
         // According to C++17 30.7.5.2.1, setting failbit *does not seem*
         // required when the sentry is not sound
         if (sets_failbit) {
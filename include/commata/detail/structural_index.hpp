@@ -0,0 +1,125 @@
+/**
+ * These codes are licensed under the Unlicense.
+ * http://unlicense.org
+ */
+
+#ifndef COMMATA_GUARD_695E4535_3923_4BE5_9278_8899A2E9A26A
+#define COMMATA_GUARD_695E4535_3923_4BE5_9278_8899A2E9A26A
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "char_search.hpp"
+
+namespace commata::detail {
+
+// Classifies a window of chars at once into bit masks of "structural" chars,
+// that is, quotation marks, line terminators and delimiters which are not
+// enclosed by quotation marks, so that the parser can jump from one
+// structural char to the next one by counting trailing zeros
+template <class Ch, Ch Delimiter, Ch Quote, Ch Cr, Ch Lf>
+class structural_index
+{
+    static constexpr std::size_t block_size = 64;
+    static constexpr std::size_t window_blocks = 64;
+
+    const Ch* window_begin_;
+    const Ch* window_end_;
+    std::size_t block_count_;
+    // All ones if window_end_ is enclosed by quotation marks, zero otherwise
+    std::uint64_t carry_;
+    std::uint64_t structurals_[window_blocks];
+
+public:
+    structural_index() noexcept :
+        window_begin_(nullptr), window_end_(nullptr), block_count_(0),
+        carry_(0)
+    {}
+
+    // Discards the current window; must be called when the buffer on which
+    // the window lies is changed
+    void reset() noexcept
+    {
+        window_begin_ = nullptr;
+        window_end_ = nullptr;
+        block_count_ = 0;
+    }
+
+    // Returns the first position of a structural char in [p, pe), or pe if
+    // no such position exists; quoted tells whether p is enclosed by
+    // quotation marks
+    template <class C>
+    C* find(C* p, C* pe, bool quoted) noexcept
+    {
+        if ((window_end_ == nullptr) || (p < window_begin_)
+         || (window_end_ <= p)) {
+            if (p == pe) {
+                return p;
+            }
+            index(p, pe, quoted);
+        }
+        for (;;) {
+            const auto i = static_cast<std::size_t>(p - window_begin_);
+            auto b = i / block_size;
+            auto bits = structurals_[b]
+                      & (~std::uint64_t() << (i % block_size));
+            while (bits == 0) {
+                if (++b == block_count_) {
+                    break;
+                }
+                bits = structurals_[b];
+            }
+            if (bits != 0) {
+                return p + ((b * block_size
+                    + static_cast<std::size_t>(simd::countr_zero(bits))) - i);
+            }
+            p += window_end_ - p;
+            if (p == pe) {
+                return p;
+            }
+            index(p, pe, carry_ != 0);
+        }
+    }
+
+private:
+    void index(const Ch* p, const Ch* pe, bool quoted) noexcept
+    {
+        const auto n = static_cast<std::size_t>(std::min<std::ptrdiff_t>(
+            pe - p, block_size * window_blocks));
+        std::uint64_t carry = quoted ? ~std::uint64_t() : 0;
+        std::size_t b = 0;
+        for (std::size_t i = 0; i < n; i += block_size, ++b) {
+            const auto m = std::min(block_size, n - i);
+            const auto quotes = mask_any_of<Ch, Quote>(p + i, m);
+            const auto delimiters = mask_any_of<Ch, Delimiter>(p + i, m);
+            const auto terminators = mask_any_of<Ch, Cr, Lf>(p + i, m);
+            const auto enclosed = prefix_xor(quotes) ^ carry;
+            structurals_[b] = (delimiters & ~enclosed) | quotes | terminators;
+            // The most significant bit tells whether the end of this block is
+            // enclosed, even if this block is shorter than block_size
+            carry = ~std::uint64_t() * (enclosed >> (block_size - 1));
+        }
+        window_begin_ = p;
+        window_end_ = p + n;
+        block_count_ = b;
+        carry_ = carry;
+    }
+
+    // Returns a bit mask whose i-th bit is the parity of the number of set
+    // bits in [0, i] of x
+    static std::uint64_t prefix_xor(std::uint64_t x) noexcept
+    {
+        x ^= x << 1;
+        x ^= x << 2;
+        x ^= x << 4;
+        x ^= x << 8;
+        x ^= x << 16;
+        x ^= x << 32;
+        return x;
+    }
+};
+
+}
+
+#endif
@@ -11,6 +11,7 @@
 #include <optional>
 #include <string>
 #include <type_traits>
+#include <utility>
 
 namespace commata::detail {
 
@@ -53,6 +54,21 @@ struct unwrap_optional<std::optional<T>>
 template <class T>
 using unwrap_optional_t = typename unwrap_optional<T>::type;
 
+// Whether Input tells the end of the text with its member function eof
+// rather than with a read shorter than requested, which Input declares with
+// its member type reports_eof; a member function eof alone does not count
+template <class Input, class = void>
+struct reports_eof : std::false_type
+{};
+
+template <class Input>
+struct reports_eof<Input, std::void_t<typename Input::reports_eof>> :
+    std::bool_constant<Input::reports_eof::value>
+{};
+
+template <class Input>
+constexpr bool reports_eof_v = reports_eof<Input>::value;
+
 template <class... Ts>
 struct first;
 
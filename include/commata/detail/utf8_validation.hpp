@@ -0,0 +1,109 @@
+/**
+ * These codes are licensed under the Unlicense.
+ * http://unlicense.org
+ */
+
+#ifndef COMMATA_GUARD_C20EAD83_9B07_4A3A_BD61_65794130789A
+#define COMMATA_GUARD_C20EAD83_9B07_4A3A_BD61_65794130789A
+
+#include <cstddef>
+#include <cstdint>
+
+#include "char_search.hpp"
+
+namespace commata::detail {
+
+// Validates a UTF-8 text which is given in successive pieces, any of which
+// can end in the middle of a multi-byte sequence
+class utf8_validator
+{
+    // Number of continuation bytes the current sequence still needs
+    std::uint_fast8_t rest_;
+    // Range of the next continuation byte
+    unsigned char lower_;
+    unsigned char upper_;
+
+public:
+    utf8_validator() noexcept :
+        rest_(0), lower_(0x80), upper_(0xBF)
+    {}
+
+    // Returns the pointer to the first byte in [first, last) which cannot
+    // follow the bytes before it in a valid text, or last if none
+    template <class Ch>
+    Ch* operator()(Ch* first, Ch* last) noexcept
+    {
+        static_assert(sizeof(Ch) == 1);
+        while (first != last) {
+            if (rest_ == 0) {
+                first = skip_ascii(first, last);
+                if (first == last) {
+                    break;
+                }
+            }
+            const auto b = static_cast<unsigned char>(*first);
+            if (rest_ > 0) {
+                if ((b < lower_) || (b > upper_)) {
+                    return first;
+                }
+                --rest_;
+                lower_ = 0x80;
+                upper_ = 0xBF;
+            } else if (b < 0xC2) {
+                return first;       // a continuation byte or an overlong lead
+            } else if (b < 0xE0) {
+                rest_ = 1;
+            } else if (b < 0xF0) {
+                rest_ = 2;
+                if (b == 0xE0) {
+                    lower_ = 0xA0;  // overlong
+                } else if (b == 0xED) {
+                    upper_ = 0x9F;  // surrogates
+                }
+            } else if (b < 0xF5) {
+                rest_ = 3;
+                if (b == 0xF0) {
+                    lower_ = 0x90;  // overlong
+                } else if (b == 0xF4) {
+                    upper_ = 0x8F;  // beyond U+10FFFF
+                }
+            } else {
+                return first;
+            }
+            ++first;
+        }
+        return last;
+    }
+
+    // Returns whether the bytes validated so far do not end in the middle of
+    // a multi-byte sequence
+    bool complete() const noexcept
+    {
+        return rest_ == 0;
+    }
+
+private:
+    template <class Ch>
+    static Ch* skip_ascii(Ch* first, Ch* last) noexcept
+    {
+#ifdef COMMATA_SIMD_SSE2
+        while (last - first >= 16) {
+            const __m128i v =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            if (_mm_movemask_epi8(v) != 0) {
+                break;
+            }
+            first += 16;
+        }
+#endif
+        while ((first != last)
+            && (static_cast<unsigned char>(*first) < 0x80)) {
+            ++first;
+        }
+        return first;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,22 @@
+/**
+ * These codes are licensed under the Unlicense.
+ * http://unlicense.org
+ */
+
+#ifndef COMMATA_GUARD_53C91F0A_C90E_4617_A9B6_1A6BE33E7B8D
+#define COMMATA_GUARD_53C91F0A_C90E_4617_A9B6_1A6BE33E7B8D
+
+#include "text_error.hpp"
+
+namespace commata {
+
+class encoding_error :
+    public text_error
+{
+public:
+    using text_error::text_error;
+};
+
+}
+
+#endif
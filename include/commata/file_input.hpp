@@ -0,0 +1,551 @@
+/**
+ * These codes are licensed under the Unlicense.
+ * http://unlicense.org
+ */
+
+#ifndef COMMATA_GUARD_3763D991_339E_440B_8790_5F672A3819BE
+#define COMMATA_GUARD_3763D991_339E_440B_8790_5F672A3819BE
+
+// CharInputs which read files with the facilities of POSIX systems; nothing
+// is defined on other systems
+#if __has_include(<sys/mman.h>) && __has_include(<unistd.h>)
+#define COMMATA_FILE_INPUT_AVAILABLE
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "parse_csv.hpp"
+
+#include "detail/exceptions.hpp"
+
+namespace commata {
+
+namespace detail::file {
+
+[[noreturn]] inline void throw_system_error(
+    [[maybe_unused]] int e, [[maybe_unused]] const char* what)
+{
+#ifdef COMMATA_EXCEPTIONS_ENABLED
+    throw std::system_error(e, std::generic_category(), what);
+#else
+    std::abort();
+#endif
+}
+
+inline std::size_t page_size() noexcept
+{
+    static const auto n = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    return n;
+}
+
+// Owns a file descriptor, which is -1 if nothing is owned
+class file_descriptor
+{
+    int fd_;
+
+public:
+    file_descriptor() noexcept :
+        fd_(-1)
+    {}
+
+    explicit file_descriptor(int fd) noexcept :
+        fd_(fd)
+    {}
+
+    file_descriptor(file_descriptor&& other) noexcept :
+        fd_(std::exchange(other.fd_, -1))
+    {}
+
+    ~file_descriptor()
+    {
+        if (fd_ != -1) {
+            ::close(fd_);
+        }
+    }
+
+    file_descriptor& operator=(file_descriptor&& other) noexcept
+    {
+        file_descriptor(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    int get() const noexcept
+    {
+        return fd_;
+    }
+
+    void swap(file_descriptor& other) noexcept
+    {
+        std::swap(fd_, other.fd_);
+    }
+};
+
+inline file_descriptor open_to_read(const char* path)
+{
+    int fd;
+    do {
+        fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    } while ((fd == -1) && (errno == EINTR));
+    if (fd == -1) {
+        throw_system_error(errno, path);
+    }
+    return file_descriptor(fd);
+}
+
+inline ::off_t file_size(int fd)
+{
+    struct ::stat st;
+    if (::fstat(fd, &st) == -1) {
+        throw_system_error(errno, "fstat");
+    }
+    return st.st_size;
+}
+
+} // end detail::file
+
+// Reads chars from a file descriptor, which it does not own, with read, or
+// with pread from the specified offset; a trailing part of the file which is
+// shorter than a char is ignored
+template <class Ch, class Tr = std::char_traits<Ch>>
+class fd_input
+{
+    int fd_;
+    // Offset to read from with pread, or -1 to read with read
+    ::off_t offset_;
+
+public:
+    static_assert(std::is_same_v<Ch, typename Tr::char_type>);
+
+    using char_type = Ch;
+    using traits_type = Tr;
+    using size_type = std::size_t;
+
+    fd_input() noexcept :
+        fd_(-1), offset_(-1)
+    {}
+
+    explicit fd_input(int fd) noexcept :
+        fd_(fd), offset_(-1)
+    {}
+
+    fd_input(int fd, ::off_t offset) noexcept :
+        fd_(fd), offset_(offset)
+    {}
+
+    fd_input(const fd_input& other) = default;
+    fd_input& operator=(const fd_input& other) = default;
+
+    int get_fd() const noexcept
+    {
+        return fd_;
+    }
+
+    size_type operator()(Ch* out, size_type n)
+    {
+        if (fd_ == -1) {
+            return 0;
+        }
+        n = std::min(n, std::numeric_limits<size_type>::max() / sizeof(Ch));
+        const auto p = reinterpret_cast<char*>(out);
+        const auto size = n * sizeof(Ch);
+        std::size_t loaded_size = 0;
+        while (loaded_size < size) {
+            const auto m = std::min<std::size_t>(size - loaded_size,
+                std::numeric_limits<::ssize_t>::max());
+            const auto r = (offset_ == -1) ?
+                ::read(fd_, p + loaded_size, m) :
+                ::pread(fd_, p + loaded_size, m, offset_);
+            if (r == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                detail::file::throw_system_error(errno,
+                    (offset_ == -1) ? "read" : "pread");
+            } else if (r == 0) {
+                break;
+            }
+            loaded_size += static_cast<std::size_t>(r);
+            if (offset_ != -1) {
+                offset_ += r;
+            }
+        }
+        return loaded_size / sizeof(Ch);
+    }
+};
+
+// Reads chars in a byte range of a file, whose descriptor it does not own,
+// with pread; a trailing part of the range which is shorter than a char is
+// ignored
+template <class Ch, class Tr = std::char_traits<Ch>>
+class range_input
+{
+    fd_input<Ch, Tr> in_;
+    // Number of bytes which remain in the range
+    ::off_t rest_;
+
+public:
+    static_assert(std::is_same_v<Ch, typename Tr::char_type>);
+
+    using char_type = Ch;
+    using traits_type = Tr;
+    using size_type = std::size_t;
+
+    range_input() noexcept :
+        rest_(0)
+    {}
+
+    range_input(int fd, ::off_t offset, ::off_t length) noexcept :
+        in_(fd, offset), rest_(length)
+    {}
+
+    range_input(const range_input& other) = default;
+    range_input& operator=(const range_input& other) = default;
+
+    int get_fd() const noexcept
+    {
+        return in_.get_fd();
+    }
+
+    size_type operator()(Ch* out, size_type n)
+    {
+        n = static_cast<size_type>(std::min<std::common_type_t<
+                size_type, std::make_unsigned_t<::off_t>>>(n,
+            static_cast<std::make_unsigned_t<::off_t>>(rest_) / sizeof(Ch)));
+        const auto m = in_(out, n);                             // throw
+        // The file may be shorter than the range
+        rest_ = (m < n) ? 0 : (rest_ - static_cast<::off_t>(m * sizeof(Ch)));
+        return m;
+    }
+};
+
+enum class record_snap : std::uint_fast8_t
+{
+    known_unquoted, speculative
+};
+
+struct record_start
+{
+    ::off_t offset;
+    // Whether the quoting state at the offset was guessed
+    bool speculative;
+};
+
+// Finds the first record which starts at or after offset of the file, which
+// is a CSV text of Ch; with record_snap::speculative, the quoting state at
+// offset is inferred from quotation marks which can only be opening or
+// closing ones and from the end of the file, and it is guessed that offset
+// is out of quoted fields if they are not found within lookahead chars;
+// Options are those of csv_source, whose csv_dialect, if any, tells the
+// delimiter, the quotation mark and the line break chars
+template <class Ch = char, class Tr = std::char_traits<Ch>, class... Options>
+record_start snap_to_record(int fd, ::off_t offset,
+    record_snap snap = record_snap::speculative, std::size_t lookahead = 0)
+{
+    using kc_t = detail::csv::key_chars_for_t<Ch, Options...>;
+    const auto is = [](Ch c, Ch d) {
+        return Tr::eq(c, d);
+    };
+    const auto is_terminator = [is](Ch c) {
+        return is(c, kc_t::cr_c) || is(c, kc_t::lf_c);
+    };
+    const auto is_structural = [is, is_terminator](Ch c) {
+        return is_terminator(c) || is(c, kc_t::comma_c)
+            || is(c, kc_t::dquote_c);
+    };
+
+    constexpr auto w = static_cast<::off_t>(sizeof(Ch));
+    offset = offset / w * w;
+    if (offset <= 0) {
+        return { 0, false };
+    }
+    if (lookahead == 0) {
+        lookahead = 1U << 20;
+    }
+
+    // The two hypotheses on the char at offset - 1, indexed by these: it is
+    // out of quoted fields, or in a quoted field
+    constexpr unsigned out = 0;
+    constexpr unsigned in = 1;
+    // Start offsets of the first records under the hypotheses, or -1
+    ::off_t starts[2] = { -1, -1 };
+    // Index of the hypothesis which a CR just read terminates a record
+    // under, or -1
+    int after_cr = -1;
+    int decided = (snap == record_snap::known_unquoted) ? out : -1;
+    // Parity of the number of quotation marks read since offset - 1
+    unsigned parity = 0;
+
+    // Reading starts from the char at offset - 2 to know the one before
+    // offset - 1
+    ::off_t pos = std::max<::off_t>(offset - 2 * w, 0);
+    Ch prev = kc_t::lf_c;
+    bool prev_counted = false;
+    if (pos < offset - w) {
+        fd_input<Ch, Tr> first(fd, pos);
+        if (first(&prev, 1) == 0) {
+            return { offset, false };       // No records after offset
+        }
+        pos += w;
+    }
+
+    fd_input<Ch, Tr> reader(fd, pos);
+    Ch buffer[1024];
+    std::size_t scanned = 0;
+    for (;;) {
+        const auto length = reader(buffer, sizeof buffer / sizeof(Ch));
+        for (std::size_t i = 0; i < length; ++i, pos += w, ++scanned) {
+            const auto c = buffer[i];
+
+            if (after_cr != -1) {
+                starts[after_cr] = is(c, kc_t::lf_c) ? pos + w : pos;
+                after_cr = -1;
+                if ((decided != -1) && (starts[decided] != -1)) {
+                    return { starts[decided], false };
+                }
+            }
+
+            if (decided == -1) {
+                if (is(c, kc_t::dquote_c)) {
+                    // Preceded by a non-structural char, it is a closing
+                    // quotation mark, so it is in a quoted field
+                    if (!is_structural(prev)) {
+                        decided = (parity == 1) ? out : in;
+                    }
+                } else if (prev_counted && is(prev, kc_t::dquote_c)
+                        && !is_structural(c)) {
+                    // Followed by a non-structural char, the previous one is
+                    // an opening quotation mark, so it is out of quoted fields
+                    decided = (parity == 1) ? out : in;
+                } else if ((scanned >= lookahead) && (starts[out] != -1)) {
+                    return { starts[out], true };
+                }
+            }
+            if (is(c, kc_t::dquote_c)
+             && (snap != record_snap::known_unquoted)) {
+                parity ^= 1;
+            } else if (is_terminator(c)) {
+                // A record terminates here under the hypothesis which puts
+                // this char out of quoted fields
+                const unsigned h = (parity == 0) ? out : in;
+                if (starts[h] == -1) {
+                    if (is(c, kc_t::lf_c)) {
+                        starts[h] = pos + w;
+                    } else {
+                        after_cr = static_cast<int>(h);
+                    }
+                }
+            }
+
+            if ((decided != -1) && (starts[decided] != -1)) {
+                return { starts[decided], false };
+            }
+            prev = c;
+            prev_counted = true;
+        }
+        if (length < sizeof buffer / sizeof(Ch)) {
+            break;
+        }
+    }
+
+    // Reached the end of the file, which must be out of quoted fields
+    if (after_cr != -1) {
+        starts[after_cr] = pos;
+    }
+    if (decided == -1) {
+        decided = (parity == 0) ? out : in;
+    }
+    return { std::max((starts[decided] == -1) ? pos : starts[decided], offset),
+             false };
+}
+
+// Maps a file into memory window by window and hands the mapped chars to the
+// parser without copying them; a trailing part of the file which is shorter
+// than a char is ignored
+template <class Ch, class Tr = std::char_traits<Ch>>
+class mmap_input
+{
+public:
+    static_assert(std::is_same_v<Ch, typename Tr::char_type>);
+
+    using char_type = Ch;
+    using traits_type = Tr;
+    using size_type = std::size_t;
+    using reports_eof = std::true_type;
+
+    static constexpr size_type min_window_size = 1U << 20;
+    static constexpr size_type max_window_size = 1U << 26;
+    static constexpr size_type default_window_size = 1U << 24;
+
+private:
+    detail::file::file_descriptor fd_;
+    ::off_t file_size_;
+
+    // Offset of the first byte which has not been read
+    ::off_t offset_;
+
+    // Current window, which is [map_offset_, map_offset_ + map_size_) of the
+    // file, or null
+    void* map_;
+    ::off_t map_offset_;
+    size_type map_size_;
+
+    size_type window_size_;
+
+public:
+    mmap_input() noexcept :
+        file_size_(0), offset_(0), map_(nullptr), map_offset_(0),
+        map_size_(0), window_size_(default_window_size)
+    {}
+
+    explicit mmap_input(const char* path, size_type window_size = 0) :
+        fd_(detail::file::open_to_read(path)),
+        file_size_(detail::file::file_size(fd_.get())),
+        offset_(0), map_(nullptr), map_offset_(0), map_size_(0),
+        window_size_(arrange_window_size(window_size))
+    {}
+
+    explicit mmap_input(const std::string& path, size_type window_size = 0) :
+        mmap_input(path.c_str(), window_size)
+    {}
+
+    mmap_input(mmap_input&& other) noexcept :
+        fd_(std::move(other.fd_)), file_size_(other.file_size_),
+        offset_(other.offset_), map_(std::exchange(other.map_, nullptr)),
+        map_offset_(other.map_offset_), map_size_(other.map_size_),
+        window_size_(other.window_size_)
+    {
+        other.file_size_ = 0;
+        other.offset_ = 0;
+    }
+
+    ~mmap_input()
+    {
+        unmap();
+    }
+
+    mmap_input& operator=(mmap_input&& other) noexcept
+    {
+        mmap_input(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    size_type get_window_size() const noexcept
+    {
+        return window_size_;
+    }
+
+    size_type operator()(Ch* out, size_type n)
+    {
+        size_type m = 0;
+        while (m < n) {
+            const auto [p, length] = (*this)(n - m);
+            if (length == 0) {
+                break;
+            }
+            traits_type::copy(out + m, p, length);
+            m += length;
+        }
+        return m;
+    }
+
+    std::pair<const Ch*, size_type> operator()(size_type n)
+    {
+        if (eof() || (n == 0)) {
+            return { nullptr, 0 };
+        }
+        if (!map_ || (offset_ + static_cast<::off_t>(sizeof(Ch))
+                        > map_offset_ + static_cast<::off_t>(map_size_))) {
+            map_next();                                         // throw
+        }
+        const auto first = static_cast<const char*>(map_)
+                         + (offset_ - map_offset_);
+        const auto rest = static_cast<size_type>(
+            map_offset_ + static_cast<::off_t>(map_size_) - offset_);
+        const auto rlen = std::min(n, rest / sizeof(Ch));
+        offset_ += static_cast<::off_t>(rlen * sizeof(Ch));
+        return { reinterpret_cast<const Ch*>(first), rlen };
+    }
+
+    bool eof() const noexcept
+    {
+        return file_size_ - offset_ < static_cast<::off_t>(sizeof(Ch));
+    }
+
+    void swap(mmap_input& other) noexcept
+    {
+        using std::swap;
+        swap(fd_, other.fd_);
+        swap(file_size_, other.file_size_);
+        swap(offset_, other.offset_);
+        swap(map_, other.map_);
+        swap(map_offset_, other.map_offset_);
+        swap(map_size_, other.map_size_);
+        swap(window_size_, other.window_size_);
+    }
+
+private:
+    static size_type arrange_window_size(size_type window_size) noexcept
+    {
+        if (window_size == 0) {
+            window_size = default_window_size;
+        }
+        window_size = std::clamp(window_size,
+            min_window_size, max_window_size);
+        // Windows must start on page boundaries
+        const auto page = detail::file::page_size();
+        return (window_size + page - 1) / page * page;
+    }
+
+    void map_next()
+    {
+        unmap();
+        const auto page = static_cast<::off_t>(detail::file::page_size());
+        const auto map_offset = offset_ / page * page;
+        const auto map_size = static_cast<size_type>(std::min<::off_t>(
+            static_cast<::off_t>(window_size_), file_size_ - map_offset));
+        void* const map = ::mmap(nullptr, map_size, PROT_READ, MAP_PRIVATE,
+            fd_.get(), map_offset);
+        if (map == MAP_FAILED) {
+            detail::file::throw_system_error(errno, "mmap");
+        }
+        // They are only hints, so failures are ignored
+        ::madvise(map, map_size, MADV_SEQUENTIAL);
+        ::madvise(map, map_size, MADV_WILLNEED);
+        map_ = map;
+        map_offset_ = map_offset;
+        map_size_ = map_size;
+    }
+
+    void unmap() noexcept
+    {
+        if (map_) {
+            ::munmap(map_, map_size_);
+            map_ = nullptr;
+        }
+    }
+};
+
+template <class Ch, class Tr>
+void swap(mmap_input<Ch, Tr>& left, mmap_input<Ch, Tr>& right) noexcept
+{
+    left.swap(right);
+}
+
+}
+
+#endif
+
+#endif
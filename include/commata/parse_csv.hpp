@@ -15,16 +15,39 @@
 #include <utility>
 
 #include "char_input.hpp"
+#include "encoding_error.hpp"
 #include "parse_error.hpp"
 #include "wrapper_handlers.hpp"
 
 #include "detail/base_parser.hpp"
 #include "detail/base_source.hpp"
+#include "detail/char_search.hpp"
+#include "detail/full_ebo.hpp"
 #include "detail/key_chars.hpp"
+#include "detail/member_like_base.hpp"
+#include "detail/structural_index.hpp"
 #include "detail/typing_aid.hpp"
 
 namespace commata {
 
+// Option of csv_source to make its parsers classify chars into a structural
+// index window by window instead of scanning them value by value
+struct csv_indexed_engine
+{};
+
+// Option of csv_source to parse texts whose delimiter, quotation mark and
+// line break chars are not a comma, a double quote, CR and LF; a line break
+// is either of Cr, Lf or one or more Crs followed by an Lf
+template <char Delimiter, char Quote = '"', char Cr = '\r', char Lf = '\n'>
+struct csv_dialect
+{};
+
+// Option of csv_source to make its parsers skip the UTF-8 BOM at the
+// beginning of texts and throw encoding_error on invalid UTF-8 sequences, or
+// report parse_errc::invalid_utf8_sequence if they are told not to throw
+struct csv_utf8_validation
+{};
+
 namespace detail::csv {
 
 enum class state : std::int_fast8_t
@@ -53,20 +76,20 @@ struct parse_step<state::after_comma>
     void normal(Parser& parser, typename Parser::buffer_char_t* p, ...) const
     {
         switch (*p) {
-        case key_chars<typename Parser::char_type>::comma_c:
+        case Parser::key_chars_t::comma_c:
             parser.set_first_last();
             parser.finalize();
             break;
-        case key_chars<typename Parser::char_type>::dquote_c:
+        case Parser::key_chars_t::dquote_c:
             parser.change_state(state::right_of_open_quote);
             break;
-        case key_chars<typename Parser::char_type>::cr_c:
+        case Parser::key_chars_t::cr_c:
             parser.set_first_last();
             parser.finalize();
             parser.end_record();
             parser.change_state(state::after_cr);
             break;
-        case key_chars<typename Parser::char_type>::lf_c:
+        case Parser::key_chars_t::lf_c:
             parser.set_first_last();
             parser.finalize();
             parser.end_record();
@@ -98,33 +121,35 @@ struct parse_step<state::in_value>
     void normal(Parser& parser, typename Parser::buffer_char_t*& p,
         typename Parser::buffer_char_t* pe) const
     {
-        using namespace std::string_view_literals;
-        while (p < pe) {
-            switch (*p) {
-            case key_chars<typename Parser::char_type>::comma_c:
-                parser.finalize();
-                parser.change_state(state::after_comma);
-                return;
-            case key_chars<typename Parser::char_type>::dquote_c:
-                throw parse_error(
-                    "A quotation mark found in an unquoted value"sv);
-            case key_chars<typename Parser::char_type>::cr_c:
-                parser.finalize();
-                parser.end_record();
-                parser.change_state(state::after_cr);
-                return;
-            case key_chars<typename Parser::char_type>::lf_c:
-                parser.finalize();
-                parser.end_record();
-                parser.change_state(state::after_lf);
-                return;
-            default:
-                parser.renew_last();
-                ++p;
-                break;
-            }
+        using kc_t = typename Parser::key_chars_t;
+        p = parser.find_key_in_value(p, pe);
+        parser.set_last();
+        if (p == pe) {
+            --p;
+            return;
+        }
+        switch (*p) {
+        case kc_t::comma_c:
+            parser.finalize();
+            parser.change_state(state::after_comma);
+            break;
+        case kc_t::dquote_c:
+            parser.fail(parse_errc::quotation_mark_in_unquoted_value);
+            break;
+        case kc_t::cr_c:
+            parser.finalize();
+            parser.end_record();
+            parser.change_state(state::after_cr);
+            break;
+        case kc_t::lf_c:
+            parser.finalize();
+            parser.end_record();
+            parser.change_state(state::after_lf);
+            break;
+        default:
+            assert(false);
+            break;
         }
-        --p;
     }
 
     template <class Parser>
@@ -147,7 +172,7 @@ struct parse_step<state::right_of_open_quote>
     void normal(Parser& parser, typename Parser::buffer_char_t* p, ...) const
     {
         parser.set_first_last();
-        if (*p == key_chars<typename Parser::char_type>::dquote_c) {
+        if (*p == Parser::key_chars_t::dquote_c) {
             parser.change_state(state::in_quoted_value_after_quote);
         } else {
             parser.renew_last();
@@ -160,10 +185,9 @@ struct parse_step<state::right_of_open_quote>
     {}
 
     template <class Parser>
-    void eof(Parser& /*parser*/) const
+    void eof(Parser& parser) const
     {
-        using namespace std::string_view_literals;
-        throw parse_error("EOF reached with an open quoted value"sv);
+        parser.fail(parse_errc::eof_in_quoted_value);
     }
 };
 
@@ -174,28 +198,31 @@ struct parse_step<state::in_quoted_value>
     void normal(Parser& parser, typename Parser::buffer_char_t*& p,
         typename Parser::buffer_char_t* pe) const
     {
-        while (p < pe) {
-            switch (*p) {
-            case key_chars<typename Parser::char_type>::dquote_c:
-                parser.update();
-                parser.set_first_last();
-                parser.change_state(state::in_quoted_value_after_quote);
-                return;
-            case key_chars<typename Parser::char_type>::cr_c:
-                parser.renew_last();
-                parser.change_state(state::in_quoted_value_after_cr);
-                return;
-            case key_chars<typename Parser::char_type>::lf_c:
-                parser.renew_last();
-                parser.change_state(state::in_quoted_value_after_lf);
-                return;
-            default:
-                parser.renew_last();
-                break;
-            }
-            ++p;
+        using kc_t = typename Parser::key_chars_t;
+        p = parser.find_key_in_quoted_value(p, pe);
+        parser.set_last();
+        if (p == pe) {
+            --p;
+            return;
+        }
+        switch (*p) {
+        case kc_t::dquote_c:
+            parser.update();
+            parser.set_first_last();
+            parser.change_state(state::in_quoted_value_after_quote);
+            break;
+        case kc_t::cr_c:
+            parser.renew_last();
+            parser.change_state(state::in_quoted_value_after_cr);
+            break;
+        case kc_t::lf_c:
+            parser.renew_last();
+            parser.change_state(state::in_quoted_value_after_lf);
+            break;
+        default:
+            assert(false);
+            break;
         }
-        --p;
     }
 
     template <class Parser>
@@ -205,10 +232,9 @@ struct parse_step<state::in_quoted_value>
     }
 
     template <class Parser>
-    void eof(Parser& /*parser*/) const
+    void eof(Parser& parser) const
     {
-        using namespace std::string_view_literals;
-        throw parse_error("EOF reached with an open quoted value"sv);
+        parser.fail(parse_errc::eof_in_quoted_value);
     }
 };
 
@@ -218,30 +244,29 @@ struct parse_step<state::in_quoted_value_after_quote>
     template <class Parser>
     void normal(Parser& parser, typename Parser::buffer_char_t* p, ...) const
     {
-        using namespace std::string_view_literals;
         switch (*p) {
-        case key_chars<typename Parser::char_type>::comma_c:
+        case Parser::key_chars_t::comma_c:
             parser.finalize();
             parser.change_state(state::after_comma);
             break;
-        case key_chars<typename Parser::char_type>::dquote_c:
+        case Parser::key_chars_t::dquote_c:
             parser.set_first_last();
             parser.renew_last();
             parser.change_state(state::in_quoted_value);
             break;
-        case key_chars<typename Parser::char_type>::cr_c:
+        case Parser::key_chars_t::cr_c:
             parser.finalize();
             parser.end_record();
             parser.change_state(state::after_cr);
             break;
-        case key_chars<typename Parser::char_type>::lf_c:
+        case Parser::key_chars_t::lf_c:
             parser.finalize();
             parser.end_record();
             parser.change_state(state::after_lf);
             break;
         default:
-            throw parse_error(
-                "An invalid character found after a closed quoted value"sv);
+            parser.fail(parse_errc::invalid_char_after_quoted_value);
+            break;
         }
     }
 
@@ -263,17 +288,17 @@ struct parse_step<state::in_quoted_value_after_cr>
     void normal(Parser& parser, typename Parser::buffer_char_t* p, ...) const
     {
         switch (*p) {
-        case key_chars<typename Parser::char_type>::dquote_c:
+        case Parser::key_chars_t::dquote_c:
             parser.new_physical_line();
             parser.update();
             parser.set_first_last();
             parser.change_state(state::in_quoted_value_after_quote);
             break;
-        case key_chars<typename Parser::char_type>::cr_c:
+        case Parser::key_chars_t::cr_c:
             parser.renew_last();
             parser.change_state(state::in_quoted_value_after_crs);
             break;
-        case key_chars<typename Parser::char_type>::lf_c:
+        case Parser::key_chars_t::lf_c:
             parser.renew_last();
             parser.change_state(state::in_quoted_value_after_lf);
             break;
@@ -292,10 +317,9 @@ struct parse_step<state::in_quoted_value_after_cr>
     }
 
     template <class Parser>
-    void eof(Parser& /*parser*/) const
+    void eof(Parser& parser) const
     {
-        using namespace std::string_view_literals;
-        throw parse_error("EOF reached with an open quoted value"sv);
+        parser.fail(parse_errc::eof_in_quoted_value);
     }
 };
 
@@ -306,16 +330,16 @@ struct parse_step<state::in_quoted_value_after_crs>
     void normal(Parser& parser, typename Parser::buffer_char_t* p, ...) const
     {
         switch (*p) {
-        case key_chars<typename Parser::char_type>::dquote_c:
+        case Parser::key_chars_t::dquote_c:
             parser.new_physical_line();
             parser.update();
             parser.set_first_last();
             parser.change_state(state::in_quoted_value_after_quote);
             break;
-        case key_chars<typename Parser::char_type>::cr_c:
+        case Parser::key_chars_t::cr_c:
             parser.renew_last();
             break;
-        case key_chars<typename Parser::char_type>::lf_c:
+        case Parser::key_chars_t::lf_c:
             parser.renew_last();
             parser.change_state(state::in_quoted_value_after_lf);
             break;
@@ -334,10 +358,9 @@ struct parse_step<state::in_quoted_value_after_crs>
     }
 
     template <class Parser>
-    void eof(Parser& /*parser*/) const
+    void eof(Parser& parser) const
     {
-        using namespace std::string_view_literals;
-        throw parse_error("EOF reached with an open quoted value"sv);
+        parser.fail(parse_errc::eof_in_quoted_value);
     }
 };
 
@@ -348,17 +371,17 @@ struct parse_step<state::in_quoted_value_after_lf>
     void normal(Parser& parser, typename Parser::buffer_char_t* p, ...) const
     {
         switch (*p) {
-        case key_chars<typename Parser::char_type>::dquote_c:
+        case Parser::key_chars_t::dquote_c:
             parser.new_physical_line();
             parser.update();
             parser.set_first_last();
             parser.change_state(state::in_quoted_value_after_quote);
             break;
-        case key_chars<typename Parser::char_type>::cr_c:
+        case Parser::key_chars_t::cr_c:
             parser.renew_last();
             parser.change_state(state::in_quoted_value_after_cr);
             break;
-        case key_chars<typename Parser::char_type>::lf_c:
+        case Parser::key_chars_t::lf_c:
             parser.new_physical_line();
             parser.renew_last();
             break;
@@ -377,10 +400,9 @@ struct parse_step<state::in_quoted_value_after_lf>
     }
 
     template <class Parser>
-    void eof(Parser& /*parser*/) const
+    void eof(Parser& parser) const
     {
-        using namespace std::string_view_literals;
-        throw parse_error("EOF reached with an open quoted value"sv);
+        parser.fail(parse_errc::eof_in_quoted_value);
     }
 };
 
@@ -391,22 +413,22 @@ struct parse_step<state::after_cr>
     void normal(Parser& parser, typename Parser::buffer_char_t* p, ...) const
     {
         switch (*p) {
-        case key_chars<typename Parser::char_type>::comma_c:
+        case Parser::key_chars_t::comma_c:
             parser.new_physical_line();
             parser.set_first_last();
             parser.finalize();
             parser.change_state(state::after_comma);
             break;
-        case key_chars<typename Parser::char_type>::dquote_c:
+        case Parser::key_chars_t::dquote_c:
             parser.new_physical_line();
             parser.force_start_record();
             parser.change_state(state::right_of_open_quote);
             break;
-        case key_chars<typename Parser::char_type>::cr_c:
+        case Parser::key_chars_t::cr_c:
             parser.new_physical_line();
             parser.change_state(state::after_crs);
             break;
-        case key_chars<typename Parser::char_type>::lf_c:
+        case Parser::key_chars_t::lf_c:
             parser.change_state(state::after_lf);
             break;
         default:
@@ -434,20 +456,20 @@ struct parse_step<state::after_crs>
     void normal(Parser& parser, typename Parser::buffer_char_t* p, ...) const
     {
         switch (*p) {
-        case key_chars<typename Parser::char_type>::comma_c:
+        case Parser::key_chars_t::comma_c:
             parser.new_physical_line();
             parser.set_first_last();
             parser.finalize();
             parser.change_state(state::after_comma);
             break;
-        case key_chars<typename Parser::char_type>::dquote_c:
+        case Parser::key_chars_t::dquote_c:
             parser.new_physical_line();
             parser.force_start_record();
             parser.change_state(state::right_of_open_quote);
             break;
-        case key_chars<typename Parser::char_type>::cr_c:
+        case Parser::key_chars_t::cr_c:
             break;
-        case key_chars<typename Parser::char_type>::lf_c:
+        case Parser::key_chars_t::lf_c:
             parser.change_state(state::after_lf);
             break;
         default:
@@ -477,20 +499,20 @@ struct parse_step<state::after_lf>
     {
         parser.new_physical_line();
         switch (*p) {
-        case key_chars<typename Parser::char_type>::comma_c:
+        case Parser::key_chars_t::comma_c:
             parser.set_first_last();
             parser.finalize();
             parser.change_state(state::after_comma);
             break;
-        case key_chars<typename Parser::char_type>::dquote_c:
+        case Parser::key_chars_t::dquote_c:
             parser.force_start_record();
             parser.change_state(state::right_of_open_quote);
             break;
-        case key_chars<typename Parser::char_type>::cr_c:
+        case Parser::key_chars_t::cr_c:
             parser.empty_physical_line();
             parser.change_state(state::after_cr);
             break;
-        case key_chars<typename Parser::char_type>::lf_c:
+        case Parser::key_chars_t::lf_c:
             parser.empty_physical_line();
             break;
         default:
@@ -510,15 +532,148 @@ struct parse_step<state::after_lf>
     {}
 };
 
-template <class Input, class Handler>
-class parser :
-    public detail::base_parser<Input, Handler, state, parser<Input, Handler>>
+template <class T>
+constexpr bool is_csv_dialect_v = false;
+
+template <char Delimiter, char Quote, char Cr, char Lf>
+constexpr bool is_csv_dialect_v<csv_dialect<Delimiter, Quote, Cr, Lf>> =
+    true;
+
+template <class... Options>
+struct dialect_of
+{
+    using type = void;
+};
+
+template <class Head, class... Tail>
+struct dialect_of<Head, Tail...>
+{
+    using type = std::conditional_t<is_csv_dialect_v<Head>,
+        Head, typename dialect_of<Tail...>::type>;
+};
+
+template <class Ch, class Dialect>
+struct dialect_key_chars : key_chars<Ch>
+{};
+
+template <class Ch, char Delimiter, char Quote, char Cr, char Lf>
+struct dialect_key_chars<Ch, csv_dialect<Delimiter, Quote, Cr, Lf>>
+{
+    static_assert((Delimiter != Quote) && (Delimiter != Cr)
+               && (Delimiter != Lf) && (Quote != Cr) && (Quote != Lf)
+               && (Cr != Lf),
+        "Chars of csv_dialect shall be distinct from each other");
+    static_assert(std::is_same_v<Ch, char>
+               || ((Delimiter >= 0) && (Quote >= 0) && (Cr >= 0) && (Lf >= 0)),
+        "Chars of csv_dialect shall be in the basic range for wide chars");
+
+    static constexpr Ch comma_c  = static_cast<Ch>(Delimiter);
+    static constexpr Ch dquote_c = static_cast<Ch>(Quote);
+    static constexpr Ch cr_c     = static_cast<Ch>(Cr);
+    static constexpr Ch lf_c     = static_cast<Ch>(Lf);
+};
+
+template <class Ch, class... Options>
+using key_chars_for_t =
+    dialect_key_chars<Ch, typename dialect_of<Options...>::type>;
+
+// Scans values for key chars one value after another
+template <class Ch, class Kc>
+struct sequential_engine
+{
+    template <class C>
+    static C* find_key_in_value(C* p, C* pe) noexcept
+    {
+        return find_any_of<Ch,
+            Kc::comma_c, Kc::dquote_c, Kc::cr_c, Kc::lf_c>(p, pe);
+    }
+
+    template <class C>
+    static C* find_key_in_quoted_value(C* p, C* pe) noexcept
+    {
+        return find_any_of<Ch, Kc::dquote_c, Kc::cr_c, Kc::lf_c>(p, pe);
+    }
+
+    void reset() noexcept
+    {}
+};
+
+// Looks up key chars in a structural index built for a window of chars
+template <class Ch, class Kc>
+class indexed_engine
+{
+    structural_index<Ch, Kc::comma_c, Kc::dquote_c, Kc::cr_c, Kc::lf_c>
+        index_;
+
+public:
+    template <class C>
+    C* find_key_in_value(C* p, C* pe) noexcept
+    {
+        return index_.find(p, pe, false);
+    }
+
+    template <class C>
+    C* find_key_in_quoted_value(C* p, C* pe) noexcept
+    {
+        // Delimiters in quoted values are not structural chars, so what is
+        // found here is always a quotation mark, CR or LF
+        return index_.find(p, pe, true);
+    }
+
+    void reset() noexcept
+    {
+        index_.reset();
+    }
+};
+
+template <class Ch, class... Options>
+using engine_t = std::conditional_t<
+    (std::is_same_v<Options, csv_indexed_engine> || ...),
+    indexed_engine<Ch, key_chars_for_t<Ch, Options...>>,
+    sequential_engine<Ch, key_chars_for_t<Ch, Options...>>>;
+
+template <class Input, class Handler, class... Options>
+class COMMATA_FULL_EBO parser :
+    public detail::base_parser<Input, Handler, state,
+                               parser<Input, Handler, Options...>>,
+    detail::member_like_base<
+        engine_t<typename Input::char_type, Options...>>
 {
+    using base_t = detail::base_parser<Input, Handler, state,
+                                       parser<Input, Handler, Options...>>;
+    using engine_base_t = detail::member_like_base<
+        engine_t<typename Input::char_type, Options...>>;
+
 public:
+    using key_chars_t =
+        key_chars_for_t<typename Input::char_type, Options...>;
+
     static constexpr state first_state = state::after_lf;
 
-    using detail::base_parser<Input, Handler, state, parser<Input, Handler>>::
-        base_parser;
+    static constexpr bool validates_utf8 =
+        (std::is_same_v<Options, csv_utf8_validation> || ...);
+    static_assert(!validates_utf8 || (sizeof(typename Input::char_type) == 1),
+        "csv_utf8_validation is specified for csv_source whose char_type "
+        "is not one byte long");
+
+    using base_t::base_t;
+
+    void buffer_arranged() noexcept
+    {
+        engine_base_t::get().reset();
+    }
+
+    template <class C>
+    C* find_key_in_value(C* p, C* pe) noexcept
+    {
+        return engine_base_t::get().find_key_in_value(p, pe);
+    }
+
+    template <class C>
+    C* find_key_in_quoted_value(C* p, C* pe) noexcept
+    {
+        return engine_base_t::get().find_key_in_quoted_value(p, pe);
+    }
 
     template <class F>
     static void step(state s, F f)
@@ -564,12 +719,29 @@ public:
     }
 };
 
+template <class... Options>
+struct parser_for
+{
+    static_assert(((std::is_same_v<Options, csv_indexed_engine>
+                 || std::is_same_v<Options, csv_utf8_validation>
+                 || is_csv_dialect_v<Options>) && ...),
+        "Unknown option is specified for csv_source");
+    static_assert((0 + ... + (is_csv_dialect_v<Options> ? 1 : 0)) <= 1,
+        "Two or more csv_dialect options are specified for csv_source");
+
+    template <class Input, class Handler>
+    using type = parser<Input, Handler, Options...>;
+};
+
 } // end detail::csv
 
-template <class CharInput>
-class csv_source : public detail::base_source<CharInput, detail::csv::parser>
+template <class CharInput, class... Options>
+class csv_source :
+    public detail::base_source<CharInput,
+        detail::csv::parser_for<Options...>::template type>
 {
-    using base_t = detail::base_source<CharInput, detail::csv::parser>;
+    using base_t = detail::base_source<CharInput,
+        detail::csv::parser_for<Options...>::template type>;
 
 public:
     explicit csv_source(const CharInput& input) noexcept(
@@ -594,25 +766,28 @@ public:
     }
 };
 
-template <class CharInput>
-auto swap(csv_source<CharInput>& left, csv_source<CharInput>& right)
+template <class CharInput, class... Options>
+auto swap(csv_source<CharInput, Options...>& left,
+          csv_source<CharInput, Options...>& right)
     noexcept(noexcept(left.swap(right)))
  -> std::enable_if_t<std::is_swappable_v<CharInput>>
 {
     left.swap(right);
 }
 
-template <class... Args>
+template <class... Options, class... Args>
 [[nodiscard]] auto make_csv_source(Args&&... args)
     noexcept(std::is_nothrow_constructible_v<
         decltype(make_char_input(std::forward<Args>(args)...)), Args&&...>)
- -> csv_source<decltype(make_char_input(std::forward<Args>(args)...))>
+ -> csv_source<decltype(make_char_input(std::forward<Args>(args)...)),
+               Options...>
 {
-    return csv_source<decltype(make_char_input(std::forward<Args>(args)...))>(
+    return csv_source<decltype(make_char_input(std::forward<Args>(args)...)),
+                      Options...>(
         make_char_input(std::forward<Args>(args)...));
 }
 
-template <class CharInput>
+template <class... Options, class CharInput>
 [[nodiscard]] auto make_csv_source(CharInput&& input)
     noexcept(std::is_nothrow_constructible_v<
         std::decay_t<CharInput>, CharInput&&>)
@@ -622,9 +797,10 @@ template <class CharInput>
             std::decay_t<CharInput>&,
             typename std::decay_t<CharInput>::char_type*,
             typename std::decay_t<CharInput>::size_type>,
-        csv_source<std::decay_t<CharInput>>>
+        csv_source<std::decay_t<CharInput>, Options...>>
 {
-    return csv_source<std::decay_t<CharInput>>(std::forward<CharInput>(input));
+    return csv_source<std::decay_t<CharInput>, Options...>(
+        std::forward<CharInput>(input));
 }
 
 namespace detail::csv {
@@ -655,8 +831,8 @@ template <class T>
 struct is_csv_source : std::false_type
 {};
 
-template <class CharInput>
-struct is_csv_source<csv_source<CharInput>> : std::true_type
+template <class CharInput, class... Options>
+struct is_csv_source<csv_source<CharInput, Options...>> : std::true_type
 {};
 
 template <class T>
@@ -675,14 +851,16 @@ constexpr bool is_indirect_t_v = is_indirect_t<T>::value;
 
 }
 
-template <class CharInput, class... OtherArgs>
-bool parse_csv(const csv_source<CharInput>& src, OtherArgs&&... other_args)
+template <class CharInput, class... Options, class... OtherArgs>
+bool parse_csv(const csv_source<CharInput, Options...>& src,
+               OtherArgs&&... other_args)
 {
     return static_cast<bool>(src(std::forward<OtherArgs>(other_args)...)());
 }
 
-template <class CharInput, class... OtherArgs>
-bool parse_csv(csv_source<CharInput>&& src, OtherArgs&&... other_args)
+template <class CharInput, class... Options, class... OtherArgs>
+bool parse_csv(csv_source<CharInput, Options...>&& src,
+               OtherArgs&&... other_args)
 {
     return static_cast<bool>(
         std::move(src)(std::forward<OtherArgs>(other_args)...)());
@@ -708,6 +886,49 @@ auto parse_csv(Arg1&& arg1, Arg2&& arg2, OtherArgs&&... other_args)
     }
 }
 
+// The overloads below report malformations of the text to failure instead
+// of throwing parse_error
+template <class CharInput, class... Options, class... OtherArgs>
+bool parse_csv(parse_failure& failure,
+               const csv_source<CharInput, Options...>& src,
+               OtherArgs&&... other_args)
+{
+    return static_cast<bool>(
+        src(std::forward<OtherArgs>(other_args)...)(failure));
+}
+
+template <class CharInput, class... Options, class... OtherArgs>
+bool parse_csv(parse_failure& failure,
+               csv_source<CharInput, Options...>&& src,
+               OtherArgs&&... other_args)
+{
+    return static_cast<bool>(
+        std::move(src)(std::forward<OtherArgs>(other_args)...)(failure));
+}
+
+template <class Arg1, class Arg2, class... OtherArgs>
+auto parse_csv(parse_failure& failure,
+               Arg1&& arg1, Arg2&& arg2, OtherArgs&&... other_args)
+ -> std::enable_if_t<
+        !detail::csv::is_csv_source_v<std::decay_t<Arg1>>
+     && !detail::csv::is_indirect_t_v<std::decay_t<Arg1>>
+     && (detail::csv::are_make_csv_source_args_v<Arg1&&>
+      || detail::csv::are_make_csv_source_args_v<Arg1&&, Arg2&&>),
+        bool>
+{
+    if constexpr (detail::csv::are_make_csv_source_args_v<Arg1&&, Arg2&&>) {
+        return parse_csv(failure,
+                         make_csv_source(std::forward<Arg1>(arg1),
+                                         std::forward<Arg2>(arg2)),
+                         std::forward<OtherArgs>(other_args)...);
+    } else {
+        return parse_csv(failure,
+                         make_csv_source(std::forward<Arg1>(arg1)),
+                         std::forward<Arg2>(arg2),
+                         std::forward<OtherArgs>(other_args)...);
+    }
+}
+
 }
 
 #endif
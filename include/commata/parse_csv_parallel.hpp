@@ -0,0 +1,217 @@
+/**
+ * These codes are licensed under the Unlicense.
+ * http://unlicense.org
+ */
+
+#ifndef COMMATA_GUARD_4DD876C3_5F49_4EF9_83AD_F63F5B1A9367
+#define COMMATA_GUARD_4DD876C3_5F49_4EF9_83AD_F63F5B1A9367
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "char_input.hpp"
+#include "parse_csv.hpp"
+#include "text_error.hpp"
+
+#include "detail/char_search.hpp"
+
+namespace commata {
+
+namespace detail::csv {
+
+// Result of the preliminary scan of a chunk of text
+struct chunk_scan
+{
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    // Whether the chunk has an odd number of quotation marks
+    bool odd_quotes = false;
+
+    // Offsets of the first LF which is not enclosed by quotation marks on the
+    // assumption that the chunk starts outside and inside a quoted value,
+    // respectively, or npos if no such LF exists
+    std::size_t first_lf[2] = { npos, npos };
+};
+
+template <class Ch, class Kc>
+chunk_scan scan_chunk(const Ch* first, const Ch* last) noexcept
+{
+    chunk_scan r;
+    for (const Ch* p = first; ; ++p) {
+        p = find_any_of<Ch, Kc::dquote_c, Kc::lf_c>(p, last);
+        if (p == last) {
+            break;
+        } else if (*p == Kc::dquote_c) {
+            r.odd_quotes = !r.odd_quotes;
+        } else {
+            // If the chunk starts inside a quoted value, an LF after an odd
+            // number of quotation marks is outside of it, and vice versa
+            auto& lf = r.first_lf[r.odd_quotes];
+            if (lf == chunk_scan::npos) {
+                lf = static_cast<std::size_t>(p - first);
+            }
+        }
+    }
+    return r;
+}
+
+// Calls f(0), ..., f(n - 1) on n threads including the calling one;
+// f shall not throw
+template <class F>
+void run_in_parallel(std::size_t n, F f)
+{
+    struct joiner
+    {
+        std::vector<std::thread> threads;
+
+        ~joiner()
+        {
+            for (auto& t : threads) {
+                t.join();
+            }
+        }
+    } j;
+    if (n > 1) {
+        j.threads.reserve(n - 1);
+        for (std::size_t i = 1; i < n; ++i) {
+            j.threads.emplace_back(f, i);                       // throw
+        }
+    }
+    if (n > 0) {
+        f(0);
+    }
+}
+
+struct chunk_outcome
+{
+    bool succeeded = false;
+    std::size_t physical_line_count = 0;
+    std::exception_ptr exception;
+};
+
+} // end detail::csv
+
+// Parses text as CSV on multiple threads. The text is divided into at most
+// chunk_count chunks, each of which starts at the beginning of a record, and
+// factory(i) is called on the calling thread to create the handler for the
+// i-th chunk. If chunk_count is zero, the number of hardware threads is used
+// instead, but no chunk is made shorter than about one mebi chars then.
+// The result is as if the chunks were parsed one after another: the first
+// exception or abortion in the order of the chunks wins, and the physical
+// positions of exceptions are the ones in the whole text.
+// Chunk boundaries are determined on the assumption that the text is a valid
+// CSV text, so that a quotation mark opens or closes a quoted value; if a
+// stray quotation mark makes it wrong, the parse of the chunk that contains
+// the mark fails with the same error as a sequential parse would report.
+template <class... Options, class Ch, class Tr, class HandlerFactory>
+bool parse_csv_parallel(std::basic_string_view<Ch, Tr> text,
+    HandlerFactory&& factory, std::size_t chunk_count = 0)
+{
+    using namespace detail::csv;
+
+    if (chunk_count == 0) {
+        constexpr std::size_t min_chunk_size = 1U << 20;
+        chunk_count = std::min<std::size_t>(
+            std::max(std::thread::hardware_concurrency(), 1U),
+            text.size() / min_chunk_size);
+    }
+    chunk_count = std::max<std::size_t>(
+        std::min(chunk_count, text.size()), 1U);
+
+    // Counts quotation marks and finds the first LFs for each of chunks
+    // which have the same length
+    const auto raw_size = text.size() / chunk_count;
+    std::vector<chunk_scan> scans(chunk_count);
+    run_in_parallel(chunk_count, [text, raw_size, &scans](std::size_t i) {
+        const auto first = text.data() + i * raw_size;
+        const auto last = (i + 1 == scans.size()) ?
+            text.data() + text.size() : first + raw_size;
+        scans[i] = scan_chunk<Ch, key_chars_for_t<Ch, Options...>>(
+            first, last);
+    });
+
+    // Moves the boundaries of the chunks to the beginnings of records
+    std::vector<std::size_t> bounds;
+    bounds.reserve(chunk_count + 1);
+    bounds.push_back(0);
+    bool quoted = false;
+    for (std::size_t i = 0; i < chunk_count; ++i) {
+        if (i > 0) {
+            const auto lf = scans[i].first_lf[quoted];
+            if ((lf != chunk_scan::npos)
+             && (i * raw_size + lf + 1 < text.size())) {
+                bounds.push_back(i * raw_size + lf + 1);
+            }
+        }
+        quoted = (quoted != scans[i].odd_quotes);
+    }
+    bounds.push_back(text.size());
+
+    using source_t = csv_source<string_input<Ch, Tr>, Options...>;
+    using parser_t = std::invoke_result_t<source_t,
+        std::invoke_result_t<HandlerFactory&, std::size_t>>;
+    std::vector<parser_t> parsers;
+    parsers.reserve(bounds.size() - 1);
+    for (std::size_t i = 0; i + 1 < bounds.size(); ++i) {
+        parsers.push_back(source_t(string_input<Ch, Tr>(
+            text.substr(bounds[i], bounds[i + 1] - bounds[i])))(
+                factory(i)));
+        if (i > 0) {
+            // Only the first chunk can start with the BOM
+            parsers.back().disable_bom_skip();
+        }
+    }
+
+    std::vector<chunk_outcome> outcomes(parsers.size());
+    run_in_parallel(parsers.size(), [&parsers, &outcomes](std::size_t i) {
+        try {
+            outcomes[i].succeeded = static_cast<bool>(parsers[i]());
+        } catch (...) {
+            outcomes[i].exception = std::current_exception();
+        }
+        const auto line = parsers[i].get_physical_position().first;
+        outcomes[i].physical_line_count =
+            (line == text_error::npos) ? 0 : (line + 1);
+    });
+
+    std::size_t physical_line_count = 0;
+    for (const auto& outcome : outcomes) {
+        if (outcome.exception) {
+            try {
+                std::rethrow_exception(outcome.exception);
+            } catch (text_error& e) {
+                if (const auto pos = e.get_physical_position();
+                        pos && (pos->first != text_error::npos)) {
+                    e.set_physical_position(
+                        physical_line_count + pos->first, pos->second);
+                }
+                throw;
+            }
+        } else if (!outcome.succeeded) {
+            return false;
+        }
+        physical_line_count += outcome.physical_line_count;
+    }
+    return true;
+}
+
+template <class... Options, class Ch, class Tr, class Allocator,
+          class HandlerFactory>
+bool parse_csv_parallel(const std::basic_string<Ch, Tr, Allocator>& text,
+    HandlerFactory&& factory, std::size_t chunk_count = 0)
+{
+    return parse_csv_parallel<Options...>(
+        std::basic_string_view<Ch, Tr>(text),
+        std::forward<HandlerFactory>(factory), chunk_count);
+}
+
+}
+
+#endif
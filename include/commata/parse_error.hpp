@@ -6,6 +6,13 @@
 #ifndef COMMATA_GUARD_DF869B02_BDA5_4CA3_9D83_8BFF19B6ECE5
 #define COMMATA_GUARD_DF869B02_BDA5_4CA3_9D83_8BFF19B6ECE5
 
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
 #include "text_error.hpp"
 
 namespace commata {
@@ -17,6 +24,110 @@ public:
     using text_error::text_error;
 };
 
+enum class parse_errc
+{
+    quotation_mark_in_unquoted_value = 1,
+    invalid_char_after_quoted_value,
+    eof_in_quoted_value,
+    invalid_utf8_sequence
+};
+
+namespace detail {
+
+inline const char* get_parse_errc_message(parse_errc e) noexcept
+{
+    switch (e) {
+    case parse_errc::quotation_mark_in_unquoted_value:
+        return "A quotation mark found in an unquoted value";
+    case parse_errc::invalid_char_after_quoted_value:
+        return "An invalid character found after a closed quoted value";
+    case parse_errc::eof_in_quoted_value:
+        return "EOF reached with an open quoted value";
+    case parse_errc::invalid_utf8_sequence:
+        return "An invalid UTF-8 sequence found";
+    default:
+        return "Unknown parse error";
+    }
+}
+
+class parse_error_category_impl : public std::error_category
+{
+public:
+    const char* name() const noexcept override
+    {
+        return "commata.parse";
+    }
+
+    std::string message(int ev) const override
+    {
+        return get_parse_errc_message(static_cast<parse_errc>(ev));
+    }
+};
+
+}
+
+inline const std::error_category& parse_error_category() noexcept
+{
+    static const detail::parse_error_category_impl category;
+    return category;
+}
+
+inline std::error_code make_error_code(parse_errc e) noexcept
+{
+    return std::error_code(static_cast<int>(e), parse_error_category());
+}
+
+// Describes a malformation of a text reported by a text parser which is told
+// not to throw parse_error
+class parse_failure
+{
+    std::error_code ec_;
+    std::pair<std::size_t, std::size_t> pos_;
+
+public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    parse_failure() noexcept :
+        pos_(npos, npos)
+    {}
+
+    explicit parse_failure(std::error_code ec,
+        std::size_t line = npos, std::size_t col = npos) noexcept :
+        ec_(ec), pos_(line, col)
+    {}
+
+    parse_failure(const parse_failure&) = default;
+    parse_failure& operator=(const parse_failure&) = default;
+
+    explicit operator bool() const noexcept
+    {
+        return static_cast<bool>(ec_);
+    }
+
+    std::error_code get_error_code() const noexcept
+    {
+        return ec_;
+    }
+
+    std::optional<std::pair<std::size_t, std::size_t>>
+        get_physical_position() const noexcept
+    {
+        if (pos_ != std::make_pair(npos, npos)) {
+            return pos_;
+        } else {
+            return std::nullopt;
+        }
+    }
+};
+
+}
+
+namespace std {
+
+template <>
+struct is_error_code_enum<commata::parse_errc> : true_type
+{};
+
 }
 
 #endif
@@ -15,16 +15,23 @@
 #include <utility>
 
 #include "char_input.hpp"
+#include "encoding_error.hpp"
 #include "parse_error.hpp"
 #include "wrapper_handlers.hpp"
 
 #include "detail/base_parser.hpp"
 #include "detail/base_source.hpp"
+#include "detail/char_search.hpp"
 #include "detail/key_chars.hpp"
 #include "detail/typing_aid.hpp"
 
 namespace commata {
 
+// Option of tsv_source to make its parsers skip the UTF-8 BOM at the
+// beginning of texts and throw encoding_error on invalid UTF-8 sequences
+struct tsv_utf8_validation
+{};
+
 namespace detail::tsv {
 
 enum class state : std::int_fast8_t
@@ -89,29 +96,33 @@ struct parse_step<state::in_value>
     void normal(Parser& parser, typename Parser::buffer_char_t*& p,
         typename Parser::buffer_char_t* pe) const
     {
-        while (p < pe) {
-            switch (*p) {
-            case key_chars<typename Parser::char_type>::tab_c:
-                parser.finalize();
-                parser.change_state(state::after_tab);
-                return;
-            case key_chars<typename Parser::char_type>::cr_c:
-                parser.finalize();
-                parser.end_record();
-                parser.change_state(state::after_cr);
-                return;
-            case key_chars<typename Parser::char_type>::lf_c:
-                parser.finalize();
-                parser.end_record();
-                parser.change_state(state::after_lf);
-                return;
-            default:
-                parser.renew_last();
-                ++p;
-                break;
-            }
+        using kc_t = key_chars<typename Parser::char_type>;
+        p = find_any_of<typename Parser::char_type,
+            kc_t::tab_c, kc_t::cr_c, kc_t::lf_c>(p, pe);
+        parser.set_last();
+        if (p == pe) {
+            --p;
+            return;
+        }
+        switch (*p) {
+        case kc_t::tab_c:
+            parser.finalize();
+            parser.change_state(state::after_tab);
+            break;
+        case kc_t::cr_c:
+            parser.finalize();
+            parser.end_record();
+            parser.change_state(state::after_cr);
+            break;
+        case kc_t::lf_c:
+            parser.finalize();
+            parser.end_record();
+            parser.change_state(state::after_lf);
+            break;
+        default:
+            assert(false);
+            break;
         }
-        --p;
     }
 
     template <class Parser>
@@ -239,15 +250,24 @@ struct parse_step<state::after_lf>
     {}
 };
 
-template <class Input, class Handler>
+template <class Input, class Handler, class... Options>
 class parser :
-    public detail::base_parser<Input, Handler, state, parser<Input, Handler>>
+    public detail::base_parser<Input, Handler, state,
+                               parser<Input, Handler, Options...>>
 {
+    using base_t = detail::base_parser<Input, Handler, state,
+                                       parser<Input, Handler, Options...>>;
+
 public:
     static constexpr state first_state = state::after_lf;
 
-    using detail::base_parser<Input, Handler, state, parser<Input, Handler>>::
-        base_parser;
+    static constexpr bool validates_utf8 =
+        (std::is_same_v<Options, tsv_utf8_validation> || ...);
+    static_assert(!validates_utf8 || (sizeof(typename Input::char_type) == 1),
+        "tsv_utf8_validation is specified for tsv_source whose char_type "
+        "is not one byte long");
+
+    using base_t::base_t;
 
     template <class F>
     static void step(state s, F f)
@@ -275,12 +295,25 @@ public:
     }
 };
 
+template <class... Options>
+struct parser_for
+{
+    static_assert((std::is_same_v<Options, tsv_utf8_validation> && ...),
+        "Unknown option is specified for tsv_source");
+
+    template <class Input, class Handler>
+    using type = parser<Input, Handler, Options...>;
+};
+
 } // end detail::tsv
 
-template <class CharInput>
-class tsv_source : public detail::base_source<CharInput, detail::tsv::parser>
+template <class CharInput, class... Options>
+class tsv_source :
+    public detail::base_source<CharInput,
+        detail::tsv::parser_for<Options...>::template type>
 {
-    using base_t = detail::base_source<CharInput, detail::tsv::parser>;
+    using base_t = detail::base_source<CharInput,
+        detail::tsv::parser_for<Options...>::template type>;
 
 public:
     explicit tsv_source(const CharInput& input) noexcept(
@@ -305,25 +338,28 @@ public:
     }
 };
 
-template <class CharInput>
-auto swap(tsv_source<CharInput>& left, tsv_source<CharInput>& right)
+template <class CharInput, class... Options>
+auto swap(tsv_source<CharInput, Options...>& left,
+          tsv_source<CharInput, Options...>& right)
     noexcept(noexcept(left.swap(right)))
  -> std::enable_if_t<std::is_swappable_v<CharInput>>
 {
     left.swap(right);
 }
 
-template <class... Args>
+template <class... Options, class... Args>
 [[nodiscard]] auto make_tsv_source(Args&&... args)
     noexcept(std::is_nothrow_constructible_v<
         decltype(make_char_input(std::forward<Args>(args)...)), Args&&...>)
- -> tsv_source<decltype(make_char_input(std::forward<Args>(args)...))>
+ -> tsv_source<decltype(make_char_input(std::forward<Args>(args)...)),
+               Options...>
 {
-    return tsv_source<decltype(make_char_input(std::forward<Args>(args)...))>(
+    return tsv_source<decltype(make_char_input(std::forward<Args>(args)...)),
+                      Options...>(
         make_char_input(std::forward<Args>(args)...));
 }
 
-template <class CharInput>
+template <class... Options, class CharInput>
 [[nodiscard]] auto make_tsv_source(CharInput&& input)
     noexcept(std::is_nothrow_constructible_v<
         std::decay_t<CharInput>, CharInput&&>)
@@ -333,9 +369,10 @@ template <class CharInput>
             std::decay_t<CharInput>&,
             typename std::decay_t<CharInput>::char_type*,
             typename std::decay_t<CharInput>::size_type>,
-        tsv_source<std::decay_t<CharInput>>>
+        tsv_source<std::decay_t<CharInput>, Options...>>
 {
-    return tsv_source<std::decay_t<CharInput>>(std::forward<CharInput>(input));
+    return tsv_source<std::decay_t<CharInput>, Options...>(
+        std::forward<CharInput>(input));
 }
 
 namespace detail::tsv {
@@ -366,8 +403,8 @@ template <class T>
 struct is_tsv_source : std::false_type
 {};
 
-template <class CharInput>
-struct is_tsv_source<tsv_source<CharInput>> : std::true_type
+template <class CharInput, class... Options>
+struct is_tsv_source<tsv_source<CharInput, Options...>> : std::true_type
 {};
 
 template <class T>
@@ -386,14 +423,16 @@ constexpr bool is_indirect_t_v = is_indirect_t<T>::value;
 
 }
 
-template <class CharInput, class... OtherArgs>
-bool parse_tsv(const tsv_source<CharInput>& src, OtherArgs&&... other_args)
+template <class CharInput, class... Options, class... OtherArgs>
+bool parse_tsv(const tsv_source<CharInput, Options...>& src,
+               OtherArgs&&... other_args)
 {
     return static_cast<bool>(src(std::forward<OtherArgs>(other_args)...)());
 }
 
-template <class CharInput, class... OtherArgs>
-bool parse_tsv(tsv_source<CharInput>&& src, OtherArgs&&... other_args)
+template <class CharInput, class... Options, class... OtherArgs>
+bool parse_tsv(tsv_source<CharInput, Options...>&& src,
+               OtherArgs&&... other_args)
 {
     return static_cast<bool>(
         std::move(src)(std::forward<OtherArgs>(other_args)...)());
@@ -419,6 +458,49 @@ auto parse_tsv(Arg1&& arg1, Arg2&& arg2, OtherArgs&&... other_args)
     }
 }
 
+// The overloads below report malformations of the text to failure instead
+// of throwing parse_error
+template <class CharInput, class... Options, class... OtherArgs>
+bool parse_tsv(parse_failure& failure,
+               const tsv_source<CharInput, Options...>& src,
+               OtherArgs&&... other_args)
+{
+    return static_cast<bool>(
+        src(std::forward<OtherArgs>(other_args)...)(failure));
+}
+
+template <class CharInput, class... Options, class... OtherArgs>
+bool parse_tsv(parse_failure& failure,
+               tsv_source<CharInput, Options...>&& src,
+               OtherArgs&&... other_args)
+{
+    return static_cast<bool>(
+        std::move(src)(std::forward<OtherArgs>(other_args)...)(failure));
+}
+
+template <class Arg1, class Arg2, class... OtherArgs>
+auto parse_tsv(parse_failure& failure,
+               Arg1&& arg1, Arg2&& arg2, OtherArgs&&... other_args)
+ -> std::enable_if_t<
+        !detail::tsv::is_tsv_source_v<std::decay_t<Arg1>>
+     && !detail::tsv::is_indirect_t_v<std::decay_t<Arg1>>
+     && (detail::tsv::are_make_tsv_source_args_v<Arg1&&>
+      || detail::tsv::are_make_tsv_source_args_v<Arg1&&, Arg2&&>),
+        bool>
+{
+    if constexpr (detail::tsv::are_make_tsv_source_args_v<Arg1&&, Arg2&&>) {
+        return parse_tsv(failure,
+                         make_tsv_source(std::forward<Arg1>(arg1),
+                                         std::forward<Arg2>(arg2)),
+                         std::forward<OtherArgs>(other_args)...);
+    } else {
+        return parse_tsv(failure,
+                         make_tsv_source(std::forward<Arg1>(arg1)),
+                         std::forward<Arg2>(arg2),
+                         std::forward<OtherArgs>(other_args)...);
+    }
+}
+
 }
 
 #endif
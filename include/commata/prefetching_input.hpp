@@ -0,0 +1,302 @@
+/**
+ * These codes are licensed under the Unlicense.
+ * http://unlicense.org
+ */
+
+#ifndef COMMATA_GUARD_4627DDC8_FA07_4990_957A_358D44EAD3E3
+#define COMMATA_GUARD_4627DDC8_FA07_4990_957A_358D44EAD3E3
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "detail/exceptions.hpp"
+#include "detail/typing_aid.hpp"
+
+namespace commata {
+
+namespace detail::prefetch {
+
+// Ring of buffers shared by the reading thread, which fills them with chars
+// read from Input, and the parsing thread, which consumes them in order
+template <class Input>
+class ring
+{
+    using char_type = typename Input::char_type;
+    using size_type = typename Input::size_type;
+
+public:
+    struct slot
+    {
+        std::unique_ptr<char_type[]> buffer;
+        std::size_t length = 0;
+        bool filled = false;
+        // Whether this is the last slot of the input
+        bool last = false;
+    };
+
+private:
+    Input in_;
+    std::size_t buffer_size_;
+    std::vector<slot> slots_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_;
+    std::exception_ptr exception_;
+
+public:
+    ring(Input&& in, std::size_t buffer_size, std::size_t buffer_count) :
+        in_(std::move(in)), buffer_size_(buffer_size),
+        slots_(buffer_count), stopping_(false)
+    {
+        for (auto& s : slots_) {
+            s.buffer.reset(new char_type[buffer_size]);
+        }
+    }
+
+    std::size_t buffer_count() const noexcept
+    {
+        return slots_.size();
+    }
+
+    std::size_t buffer_size() const noexcept
+    {
+        return buffer_size_;
+    }
+
+    // Runs on the reading thread
+    void fill() noexcept
+    {
+        for (std::size_t i = 0;; i = (i + 1) % slots_.size()) {
+            auto& s = slots_[i];
+            {
+                std::unique_lock lock(mutex_);
+                cv_.wait(lock, [this, &s] { return stopping_ || !s.filled; });
+                if (stopping_) {
+                    return;
+                }
+            }
+            std::size_t length = 0;
+            bool last;
+#ifdef COMMATA_EXCEPTIONS_ENABLED
+            try {
+#endif
+                length = static_cast<std::size_t>(in_(s.buffer.get(),
+                    static_cast<size_type>(buffer_size_)));
+                if constexpr (reports_eof_v<Input>) {
+                    last = in_.eof();
+                } else {
+                    last = (length < buffer_size_);
+                }
+#ifdef COMMATA_EXCEPTIONS_ENABLED
+            } catch (...) {
+                std::lock_guard lock(mutex_);
+                exception_ = std::current_exception();
+                cv_.notify_all();
+                return;
+            }
+#endif
+            std::lock_guard lock(mutex_);
+            s.length = length;
+            s.filled = true;
+            s.last = last;
+            cv_.notify_all();
+            if (last) {
+                return;
+            }
+        }
+    }
+
+    void stop() noexcept
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+        cv_.notify_all();
+    }
+
+    // Waits for the i-th slot to be filled and returns it, which the reading
+    // thread does not touch until it is released; rethrows the exception
+    // thrown by Input on the reading thread if any, after all the slots
+    // filled before it have been consumed
+    const slot& acquire(std::size_t i)
+    {
+        auto& s = slots_[i];
+        std::unique_lock lock(mutex_);
+        cv_.wait(lock, [this, &s] { return s.filled || exception_; });
+#ifdef COMMATA_EXCEPTIONS_ENABLED
+        if (!s.filled) {
+            std::rethrow_exception(exception_);
+        }
+#endif
+        return s;
+    }
+
+    void release(std::size_t i) noexcept
+    {
+        std::lock_guard lock(mutex_);
+        slots_[i].filled = false;
+        cv_.notify_all();
+    }
+};
+
+} // end detail::prefetch
+
+// Reads chars from Input on a helper thread into a ring of buffers ahead of
+// the parser, so that reading the input overlaps with parsing; the parser
+// reads the buffers directly and may modify the chars on them
+template <class Input>
+class prefetching_input
+{
+public:
+    using base_type = Input;
+    using char_type = typename Input::char_type;
+    using traits_type = typename Input::traits_type;
+    using size_type = std::size_t;
+    using reports_eof = std::true_type;
+
+    static constexpr std::size_t default_buffer_size = 1U << 16;
+    static constexpr std::size_t default_buffer_count = 2;
+
+private:
+    using ring_t = detail::prefetch::ring<Input>;
+
+    std::unique_ptr<ring_t> ring_;
+    std::thread thread_;
+
+    // Slot which is being consumed
+    std::size_t i_;
+    // Whether the i_-th slot has been acquired
+    bool holding_;
+    // [first_, first_ + length_) is the rest of the i_-th slot
+    char_type* first_;
+    std::size_t length_;
+    bool last_;
+    bool eof_;
+
+public:
+    prefetching_input() noexcept :
+        i_(0), holding_(false), first_(nullptr), length_(0), last_(false),
+        eof_(true)
+    {}
+
+    explicit prefetching_input(Input in, std::size_t buffer_size = 0,
+            std::size_t buffer_count = 0) :
+        ring_(std::make_unique<ring_t>(std::move(in),
+            (buffer_size == 0) ? default_buffer_size : buffer_size,
+            std::max<std::size_t>(
+                (buffer_count == 0) ? default_buffer_count : buffer_count,
+                2))),
+        i_(0), holding_(false), first_(nullptr), length_(0), last_(false),
+        eof_(false)
+    {
+        thread_ = std::thread([r = ring_.get()] { r->fill(); });
+    }
+
+    prefetching_input(prefetching_input&& other) noexcept :
+        ring_(std::move(other.ring_)), thread_(std::move(other.thread_)),
+        i_(other.i_), holding_(other.holding_), first_(other.first_),
+        length_(other.length_), last_(other.last_),
+        eof_(std::exchange(other.eof_, true))
+    {}
+
+    ~prefetching_input()
+    {
+        if (thread_.joinable()) {
+            ring_->stop();
+            thread_.join();
+        }
+    }
+
+    prefetching_input& operator=(prefetching_input&& other) noexcept
+    {
+        prefetching_input(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    std::size_t get_buffer_size() const noexcept
+    {
+        return ring_ ? ring_->buffer_size() : 0;
+    }
+
+    std::size_t get_buffer_count() const noexcept
+    {
+        return ring_ ? ring_->buffer_count() : 0;
+    }
+
+    size_type operator()(char_type* out, size_type n)
+    {
+        size_type m = 0;
+        while (m < n) {
+            const auto [p, length] = (*this)(n - m);
+            if (length == 0) {
+                break;
+            }
+            traits_type::copy(out + m, p, length);
+            m += length;
+        }
+        return m;
+    }
+
+    std::pair<char_type*, size_type> operator()(size_type n)
+    {
+        if (eof_ || (n == 0)) {
+            return { nullptr, 0 };
+        }
+        if (holding_ && (length_ == 0)) {
+            // The chars on the slot are no longer referred to
+            ring_->release(i_);
+            holding_ = false;
+            i_ = (i_ + 1) % ring_->buffer_count();
+        }
+        if (!holding_) {
+            const auto& s = ring_->acquire(i_);                 // throw
+            holding_ = true;
+            first_ = s.buffer.get();
+            length_ = s.length;
+            last_ = s.last;
+        }
+        const auto rlen = std::min(n, length_);
+        const auto r = first_;
+        first_ += rlen;
+        length_ -= rlen;
+        eof_ = last_ && (length_ == 0);
+        return { r, rlen };
+    }
+
+    bool eof() const noexcept
+    {
+        return eof_;
+    }
+
+    void swap(prefetching_input& other) noexcept
+    {
+        using std::swap;
+        swap(ring_, other.ring_);
+        swap(thread_, other.thread_);
+        swap(i_, other.i_);
+        swap(holding_, other.holding_);
+        swap(first_, other.first_);
+        swap(length_, other.length_);
+        swap(last_, other.last_);
+        swap(eof_, other.eof_);
+    }
+};
+
+template <class Input>
+void swap(prefetching_input<Input>& left, prefetching_input<Input>& right)
+    noexcept
+{
+    left.swap(right);
+}
+
+}
+
+#endif
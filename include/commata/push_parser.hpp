@@ -0,0 +1,302 @@
+/**
+ * These codes are licensed under the Unlicense.
+ * http://unlicense.org
+ */
+
+#ifndef COMMATA_GUARD_309464CF_E1F7_49BA_808E_4019D459EFDF
+#define COMMATA_GUARD_309464CF_E1F7_49BA_808E_4019D459EFDF
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "parse_csv.hpp"
+#include "parse_error.hpp"
+#include "parse_tsv.hpp"
+
+#include "detail/full_ebo.hpp"
+#include "detail/handler_decorator.hpp"
+
+namespace commata {
+
+namespace detail::push {
+
+// Rest of the chunk most recently fed to a push parser; it is shared by the
+// input and the handler in the underlying parser
+template <class Ch>
+struct channel
+{
+    const Ch* first = nullptr;
+    std::size_t size = 0;   // number of the chars not read yet
+    bool eof = false;
+    Ch empty_chunk[1] = {};
+};
+
+// Input which hands the fed chunk as a whole to the parser through the
+// const-direct interface or copies it into the buffers of the handler which
+// controls them or takes non-const chars, and tells the end of the text
+// explicitly, so that a chunk of any length is not mistaken for the last one
+template <class Ch>
+class input
+{
+    channel<Ch>* channel_;
+
+public:
+    using char_type = Ch;
+    using traits_type = std::char_traits<char_type>;
+    using size_type = std::size_t;
+    using reports_eof = std::true_type;
+
+    explicit input(channel<Ch>* c) noexcept :
+        channel_(c)
+    {}
+
+    std::pair<const Ch*, size_type> operator()(size_type /*n*/) noexcept
+    {
+        const std::pair<const Ch*, size_type> chunk(
+            channel_->first, channel_->size);
+        channel_->first += channel_->size;
+        channel_->size = 0;
+        return chunk;
+    }
+
+    size_type operator()(char_type* out, size_type n) noexcept
+    {
+        const auto length = std::min(n, channel_->size);
+        traits_type::copy(out, channel_->first, length);
+        channel_->first += length;
+        channel_->size -= length;
+        return length;
+    }
+
+    bool eof() const noexcept
+    {
+        return channel_->eof;
+    }
+};
+
+// Forwards the handler calls to Handler and suspends the parser when it has
+// run out of each chunk but the last one; if Handler controls buffers, the
+// parser copies the chunks into them, so that Handler never keeps pointers
+// to the chars in the chunks after they have been parsed, and if Handler
+// takes non-const chars, into the default buffers
+template <class Handler>
+class COMMATA_FULL_EBO handler :
+    public get_buffer_t<Handler, handler<Handler>>,
+    public release_buffer_t<Handler, handler<Handler>>,
+    public start_buffer_t<Handler, handler<Handler>>,
+    public end_buffer_t<Handler, handler<Handler>>,
+    public empty_physical_line_t<Handler, handler<Handler>>,
+    public handler_core_t<Handler, handler<Handler>>,
+    public handle_exception_t<Handler, handler<Handler>>
+{
+    using ch_t = typename Handler::char_type;
+    using channel_t = channel<std::remove_const_t<ch_t>>;
+
+    Handler handler_;
+    const channel_t* channel_;
+    std::size_t yield_location_;
+
+public:
+    using char_type = ch_t;
+
+    template <class HandlerR>
+    handler(HandlerR&& h, const channel_t* c)
+        noexcept(std::is_nothrow_constructible_v<Handler, HandlerR&&>) :
+        handler_(std::forward<HandlerR>(h)), channel_(c), yield_location_(0)
+    {}
+
+    Handler& base() noexcept
+    {
+        return handler_;
+    }
+
+    const Handler& base() const noexcept
+    {
+        return handler_;
+    }
+
+    bool yield(std::size_t location) noexcept
+    {
+        if ((location == 1)
+         || ((location == 2) && (channel_->eof || (channel_->size > 0)))) {
+            return false;
+        }
+        yield_location_ = location;
+        return true;
+    }
+
+    std::size_t yield_location() const noexcept
+    {
+        return yield_location_;
+    }
+};
+
+template <class Handler, template <class> class Source>
+class base_push_parser
+{
+public:
+    using char_type = std::remove_const_t<typename Handler::char_type>;
+    using size_type = std::size_t;
+
+private:
+    using input_t = input<char_type>;
+    using handler_t = handler<Handler>;
+    using parser_t =
+        typename Source<input_t>::template parser_type<handler_t>;
+
+    // Held on the heap to keep it from moving with *this
+    std::unique_ptr<channel<char_type>> channel_;
+    parser_t parser_;
+    bool ended_;
+
+protected:
+    template <class HandlerR>
+    explicit base_push_parser(HandlerR&& h) :
+        channel_(std::make_unique<channel<char_type>>()),         // throw
+        parser_(Source<input_t>(input_t(channel_.get()))(
+            handler_t(std::forward<HandlerR>(h), channel_.get()))),
+        ended_(false)
+    {}
+
+    base_push_parser(base_push_parser&&) = default;
+    ~base_push_parser() = default;
+
+public:
+    bool feed(const char_type* data, size_type size)
+    {
+        return resume(data, size, false, [this] { return parser_(); });
+    }
+
+    bool feed(parse_failure& failure, const char_type* data, size_type size)
+    {
+        return resume(data, size, false,
+            [this, &failure] { return parser_(failure); });
+    }
+
+    bool finish()
+    {
+        return resume(nullptr, 0, true, [this] { return parser_(); });
+    }
+
+    bool finish(parse_failure& failure)
+    {
+        return resume(nullptr, 0, true,
+            [this, &failure] { return parser_(failure); });
+    }
+
+    std::pair<std::size_t, std::size_t> get_physical_position() const
+        noexcept
+    {
+        return parser_.get_physical_position();
+    }
+
+private:
+    template <class Parse>
+    bool resume(const char_type* data, size_type size, bool eof,
+        Parse parse)
+    {
+        if (ended_) {
+            return false;
+        } else if ((size == 0) && !eof) {
+            return true;
+        }
+        channel_->first = eof ? channel_->empty_chunk : data;
+        channel_->size = size;
+        channel_->eof = eof;
+        // If the parse throws, the state machine is left in the middle of a
+        // step and cannot be resumed
+        ended_ = true;
+        const bool result = static_cast<bool>(parse());
+        ended_ = eof || !result;
+        return result;
+    }
+};
+
+template <class... Options>
+struct csv_source_for
+{
+    template <class CharInput>
+    using type = csv_source<CharInput, Options...>;
+};
+
+template <class... Options>
+struct tsv_source_for
+{
+    template <class CharInput>
+    using type = tsv_source<CharInput, Options...>;
+};
+
+} // end detail::push
+
+// Parses a CSV text which is fed chunk by chunk; each call of feed parses the
+// whole chunk and returns without waiting for any more chars, and a value
+// which lies across chunks is reported to the handler through update. The
+// chunk need not outlive the call of feed, and is copied only if the handler
+// controls buffers or takes non-const chars, in which case it is copied as a
+// whole because the handler may keep or modify the chars given to it
+template <class Handler, class... Options>
+class csv_push_parser :
+    public detail::push::base_push_parser<Handler,
+        detail::push::csv_source_for<Options...>::template type>
+{
+    using base_t = detail::push::base_push_parser<Handler,
+        detail::push::csv_source_for<Options...>::template type>;
+
+public:
+    explicit csv_push_parser(const Handler& handler) :
+        base_t(handler)
+    {}
+
+    explicit csv_push_parser(Handler&& handler) :
+        base_t(std::move(handler))
+    {}
+
+    csv_push_parser(csv_push_parser&&) = default;
+    ~csv_push_parser() = default;
+};
+
+template <class... Options, class Handler>
+[[nodiscard]] auto make_csv_push_parser(Handler&& handler)
+ -> csv_push_parser<std::decay_t<Handler>, Options...>
+{
+    return csv_push_parser<std::decay_t<Handler>, Options...>(
+        std::forward<Handler>(handler));
+}
+
+// The same as csv_push_parser except that this parses a TSV text
+template <class Handler, class... Options>
+class tsv_push_parser :
+    public detail::push::base_push_parser<Handler,
+        detail::push::tsv_source_for<Options...>::template type>
+{
+    using base_t = detail::push::base_push_parser<Handler,
+        detail::push::tsv_source_for<Options...>::template type>;
+
+public:
+    explicit tsv_push_parser(const Handler& handler) :
+        base_t(handler)
+    {}
+
+    explicit tsv_push_parser(Handler&& handler) :
+        base_t(std::move(handler))
+    {}
+
+    tsv_push_parser(tsv_push_parser&&) = default;
+    ~tsv_push_parser() = default;
+};
+
+template <class... Options, class Handler>
+[[nodiscard]] auto make_tsv_push_parser(Handler&& handler)
+ -> tsv_push_parser<std::decay_t<Handler>, Options...>
+{
+    return tsv_push_parser<std::decay_t<Handler>, Options...>(
+        std::forward<Handler>(handler));
+}
+
+}
+
+#endif
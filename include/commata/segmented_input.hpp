@@ -0,0 +1,152 @@
+/**
+ * These codes are licensed under the Unlicense.
+ * http://unlicense.org
+ */
+
+#ifndef COMMATA_GUARD_8555ABA2_6A21_406D_B56B_8A50F3D6EAE6
+#define COMMATA_GUARD_8555ABA2_6A21_406D_B56B_8A50F3D6EAE6
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace commata {
+
+namespace detail::segmented {
+
+template <class Supplier>
+using segment_t = typename std::invoke_result_t<Supplier&>::value_type;
+
+// Supplies the elements of [first, last) as segments
+template <class Ch, class Tr, class Iterator>
+class range_supplier
+{
+    Iterator first_;
+    Iterator last_;
+
+public:
+    range_supplier(Iterator first, Iterator last) :
+        first_(std::move(first)), last_(std::move(last))
+    {}
+
+    std::optional<std::basic_string_view<Ch, Tr>> operator()()
+    {
+        if (first_ == last_) {
+            return std::nullopt;
+        }
+        const auto& segment = *first_;
+        ++first_;
+        return std::basic_string_view<Ch, Tr>(
+            std::data(segment), std::size(segment));
+    }
+};
+
+} // end detail::segmented
+
+// Reads a text which consists of noncontiguous segments such as frames
+// received from networks; Supplier returns the next segment as an optional
+// basic_string_view, or nullopt after the last segment, and each segment is
+// handed to the parser as a buffer without copying
+template <class Supplier>
+class segmented_input
+{
+    using segment_t = detail::segmented::segment_t<Supplier>;
+
+public:
+    using char_type = typename segment_t::value_type;
+    using traits_type = typename segment_t::traits_type;
+    using size_type = std::size_t;
+    using reports_eof = std::true_type;
+
+private:
+    Supplier supplier_;
+    // The rest of the current segment
+    segment_t segment_;
+    bool eof_;
+
+public:
+    template <class S = Supplier,
+        std::enable_if_t<std::is_default_constructible_v<S>>* = nullptr>
+    segmented_input()
+        noexcept(std::is_nothrow_default_constructible_v<Supplier>) :
+        eof_(true)
+    {}
+
+    explicit segmented_input(Supplier supplier)
+        noexcept(std::is_nothrow_move_constructible_v<Supplier>) :
+        supplier_(std::move(supplier)), eof_(false)
+    {}
+
+    segmented_input(const segmented_input& other) = default;
+    segmented_input(segmented_input&& other) = default;
+    ~segmented_input() = default;
+    segmented_input& operator=(const segmented_input& other) = default;
+    segmented_input& operator=(segmented_input&& other) = default;
+
+    size_type operator()(char_type* out, size_type n)
+    {
+        const auto [p, length] = (*this)(n);
+        traits_type::copy(out, p, length);
+        return length;
+    }
+
+    std::pair<const char_type*, size_type> operator()(size_type n)
+    {
+        while (segment_.empty()) {
+            if (eof_) {
+                return { nullptr, 0 };
+            }
+            auto next = supplier_();
+            if (next) {
+                segment_ = *next;
+            } else {
+                eof_ = true;
+            }
+        }
+        const auto length = std::min(n, segment_.size());
+        const auto p = segment_.data();
+        segment_.remove_prefix(length);
+        return { p, length };
+    }
+
+    bool eof() const noexcept
+    {
+        return eof_;
+    }
+
+    void swap(segmented_input& other)
+        noexcept(std::is_nothrow_swappable_v<Supplier>)
+    {
+        using std::swap;
+        swap(supplier_, other.supplier_);
+        swap(segment_, other.segment_);
+        swap(eof_, other.eof_);
+    }
+};
+
+template <class Supplier>
+auto swap(segmented_input<Supplier>& left, segmented_input<Supplier>& right)
+    noexcept(noexcept(left.swap(right)))
+ -> std::enable_if_t<std::is_swappable_v<Supplier>>
+{
+    left.swap(right);
+}
+
+template <class Iterator>
+[[nodiscard]] auto make_segmented_input(Iterator first, Iterator last)
+{
+    using ch_t = std::remove_const_t<std::remove_pointer_t<decltype(
+        std::data(*std::declval<Iterator&>()))>>;
+    return segmented_input(
+        detail::segmented::range_supplier<ch_t, std::char_traits<ch_t>,
+            Iterator>(std::move(first), std::move(last)));
+}
+
+}
+
+#endif
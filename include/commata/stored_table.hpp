@@ -610,6 +610,1511 @@ namespace commata {
 
 namespace detail::stored {
 
+// Stands for a pointer to a proxy object for operator-> of the iterators
+template <class T>
+class arrow_proxy
+{
+    T t_;
+
+public:
+    explicit arrow_proxy(const T& t) noexcept :
+        t_(t)
+    {}
+
+    T* operator->() noexcept
+    {
+        return std::addressof(t_);
+    }
+};
+
+// Random access iterator over the elements of Container whose elements are
+// proxies, each of which is constructed with the container and its index
+template <class Container, class Reference>
+class indexed_iterator
+{
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = Reference;
+    using difference_type   = std::ptrdiff_t;
+    using reference         = Reference;
+    using pointer           = arrow_proxy<Reference>;
+
+private:
+    Container* container_;
+    difference_type index_;
+
+    template <class OtherContainer, class OtherReference>
+    friend class indexed_iterator;
+
+public:
+    indexed_iterator() noexcept :
+        container_(nullptr), index_(0)
+    {}
+
+    indexed_iterator(Container& container, difference_type index) noexcept :
+        container_(std::addressof(container)), index_(index)
+    {}
+
+    template <class OtherContainer, class OtherReference,
+        std::enable_if_t<
+            std::is_same_v<Container, const OtherContainer>
+         && std::is_convertible_v<OtherReference, Reference>>* = nullptr>
+    indexed_iterator(
+        const indexed_iterator<OtherContainer, OtherReference>& other)
+        noexcept :
+        container_(other.container_), index_(other.index_)
+    {}
+
+    std::size_t index() const noexcept
+    {
+        return static_cast<std::size_t>(index_);
+    }
+
+    reference operator*() const
+    {
+        return reference(*container_, index());
+    }
+
+    pointer operator->() const
+    {
+        return pointer(**this);
+    }
+
+    reference operator[](difference_type n) const
+    {
+        return *(*this + n);
+    }
+
+    indexed_iterator& operator++() noexcept
+    {
+        ++index_;
+        return *this;
+    }
+
+    indexed_iterator operator++(int) noexcept
+    {
+        const auto copy = *this;
+        ++*this;
+        return copy;
+    }
+
+    indexed_iterator& operator--() noexcept
+    {
+        --index_;
+        return *this;
+    }
+
+    indexed_iterator operator--(int) noexcept
+    {
+        const auto copy = *this;
+        --*this;
+        return copy;
+    }
+
+    indexed_iterator& operator+=(difference_type n) noexcept
+    {
+        index_ += n;
+        return *this;
+    }
+
+    indexed_iterator& operator-=(difference_type n) noexcept
+    {
+        index_ -= n;
+        return *this;
+    }
+
+    friend indexed_iterator operator+(
+        indexed_iterator i, difference_type n) noexcept
+    {
+        return i += n;
+    }
+
+    friend indexed_iterator operator+(
+        difference_type n, indexed_iterator i) noexcept
+    {
+        return i += n;
+    }
+
+    friend indexed_iterator operator-(
+        indexed_iterator i, difference_type n) noexcept
+    {
+        return i -= n;
+    }
+
+    friend difference_type operator-(
+        const indexed_iterator& left, const indexed_iterator& right) noexcept
+    {
+        return left.index_ - right.index_;
+    }
+
+    friend bool operator==(
+        const indexed_iterator& left, const indexed_iterator& right) noexcept
+    {
+        return left.index_ == right.index_;
+    }
+
+    friend bool operator!=(
+        const indexed_iterator& left, const indexed_iterator& right) noexcept
+    {
+        return !(left == right);
+    }
+
+    friend bool operator<(
+        const indexed_iterator& left, const indexed_iterator& right) noexcept
+    {
+        return left.index_ < right.index_;
+    }
+
+    friend bool operator>(
+        const indexed_iterator& left, const indexed_iterator& right) noexcept
+    {
+        return right < left;
+    }
+
+    friend bool operator<=(
+        const indexed_iterator& left, const indexed_iterator& right) noexcept
+    {
+        return !(right < left);
+    }
+
+    friend bool operator>=(
+        const indexed_iterator& left, const indexed_iterator& right) noexcept
+    {
+        return !(left < right);
+    }
+};
+
+} // end detail::stored
+
+// A sequence of records which lays out the values of all of its records in
+// one array and tells the boundaries of the records with another array, so
+// that appending a record costs no allocation of its own; its elements are
+// proxies which refer to the ranges of the values
+template <class Value, class Allocator = std::allocator<Value>>
+class basic_flat_stored_content
+{
+    using at_t = std::allocator_traits<Allocator>;
+    using sa_t = typename at_t::template rebind_alloc<std::size_t>;
+
+    template <class OtherValue, class OtherAllocator>
+    friend class basic_flat_stored_content;
+
+public:
+    using allocator_type  = Allocator;
+    using size_type       = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    template <bool Const>
+    class basic_record
+    {
+        using content_t = std::conditional_t<Const,
+            const basic_flat_stored_content, basic_flat_stored_content>;
+
+    public:
+        using value_type      = Value;
+        using size_type       = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference       =
+            std::conditional_t<Const, const Value&, Value&>;
+        using const_reference = const Value&;
+        using pointer         =
+            std::conditional_t<Const, const Value*, Value*>;
+        using const_pointer   = const Value*;
+        using iterator        = pointer;
+        using const_iterator  = const_pointer;
+        using reverse_iterator       = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    private:
+        content_t* content_;
+        size_type index_;
+
+        friend class basic_flat_stored_content;
+
+        template <bool> friend class basic_record;
+
+    public:
+
+        basic_record(content_t& content, size_type index) noexcept :
+            content_(std::addressof(content)), index_(index)
+        {}
+
+        template <bool OtherConst,
+                  std::enable_if_t<Const && !OtherConst>* = nullptr>
+        basic_record(const basic_record<OtherConst>& other) noexcept :
+            content_(other.content_), index_(other.index_)
+        {}
+
+        iterator begin() const noexcept
+        {
+            return content_->values_.data() + content_->begin_of(index_);
+        }
+
+        iterator end() const noexcept
+        {
+            return content_->values_.data() + content_->ends_[index_];
+        }
+
+        const_iterator cbegin() const noexcept
+        {
+            return begin();
+        }
+
+        const_iterator cend() const noexcept
+        {
+            return end();
+        }
+
+        reverse_iterator rbegin() const noexcept
+        {
+            return reverse_iterator(end());
+        }
+
+        reverse_iterator rend() const noexcept
+        {
+            return reverse_iterator(begin());
+        }
+
+        const_reverse_iterator crbegin() const noexcept
+        {
+            return rbegin();
+        }
+
+        const_reverse_iterator crend() const noexcept
+        {
+            return rend();
+        }
+
+        size_type size() const noexcept
+        {
+            return content_->ends_[index_] - content_->begin_of(index_);
+        }
+
+        [[nodiscard]] bool empty() const noexcept
+        {
+            return size() == 0;
+        }
+
+        reference operator[](size_type pos) const noexcept
+        {
+            assert(pos < size());
+            return begin()[pos];
+        }
+
+        reference front() const noexcept
+        {
+            assert(!empty());
+            return *begin();
+        }
+
+        reference back() const noexcept
+        {
+            assert(!empty());
+            return end()[-1];
+        }
+
+        template <class... Args>
+        iterator emplace(const_iterator position, Args&&... args)
+        {
+            return content_->insert_values(index_, position,
+                [&args...](auto& values, auto p) {
+                    return values.emplace(p, std::forward<Args>(args)...);
+                });                                             // throw
+        }
+
+        iterator insert(const_iterator position, const Value& value)
+        {
+            return emplace(position, value);                   // throw
+        }
+
+        iterator insert(const_iterator position, size_type n,
+                        const Value& value)
+        {
+            return content_->insert_values(index_, position,
+                [n, &value](auto& values, auto p) {
+                    return values.insert(p, n, value);
+                });                                             // throw
+        }
+
+        template <class InputIterator,
+            std::enable_if_t<!std::is_integral_v<InputIterator>>* = nullptr>
+        iterator insert(const_iterator position,
+                        InputIterator first, InputIterator last)
+        {
+            return content_->insert_values(index_, position,
+                [first, last](auto& values, auto p) {
+                    return values.insert(p, first, last);
+                });                                             // throw
+        }
+
+        template <class... Args>
+        reference emplace_back(Args&&... args)
+        {
+            return *emplace(cend(), std::forward<Args>(args)...);   // throw
+        }
+
+        void push_back(const Value& value)
+        {
+            emplace(cend(), value);                             // throw
+        }
+
+        iterator erase(const_iterator position) noexcept
+        {
+            return erase(position, position + 1);
+        }
+
+        iterator erase(const_iterator first, const_iterator last) noexcept
+        {
+            return content_->erase_values(index_, first, last);
+        }
+
+        void pop_back() noexcept
+        {
+            assert(!empty());
+            erase(cend() - 1);
+        }
+
+        void clear() noexcept
+        {
+            erase(cbegin(), cend());
+        }
+
+        void resize(size_type n)
+        {
+            resize(n, Value());                                 // throw
+        }
+
+        void resize(size_type n, const Value& value)
+        {
+            const auto s = size();
+            if (n < s) {
+                erase(cbegin() + n, cend());
+            } else {
+                insert(cend(), n - s, value);                   // throw
+            }
+        }
+    };
+
+    using record       = basic_record<false>;
+    using const_record = basic_record<true>;
+
+    using value_type      = record;
+    using reference       = record;
+    using const_reference = const_record;
+    using iterator        = detail::stored::indexed_iterator<
+        basic_flat_stored_content, record>;
+    using const_iterator  = detail::stored::indexed_iterator<
+        const basic_flat_stored_content, const_record>;
+    using reverse_iterator       = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+private:
+    // All values of all records
+    std::vector<Value, Allocator> values_;
+    // ends_[i] is the index of the past-the-end value of the i-th record in
+    // values_
+    std::vector<size_type, sa_t> ends_;
+
+public:
+    basic_flat_stored_content() = default;
+
+    explicit basic_flat_stored_content(const Allocator& alloc) :
+        values_(alloc), ends_(sa_t(alloc))
+    {}
+
+    explicit basic_flat_stored_content(size_type n,
+        const Allocator& alloc = Allocator()) :
+        values_(alloc), ends_(n, 0, sa_t(alloc))
+    {}
+
+    basic_flat_stored_content(const basic_flat_stored_content&) = default;
+    basic_flat_stored_content(basic_flat_stored_content&&) = default;
+    ~basic_flat_stored_content() = default;
+    basic_flat_stored_content& operator=(
+        const basic_flat_stored_content&) = default;
+    basic_flat_stored_content& operator=(
+        basic_flat_stored_content&&) = default;
+
+    allocator_type get_allocator() const noexcept
+    {
+        return values_.get_allocator();
+    }
+
+    iterator begin() noexcept
+    {
+        return iterator(*this, 0);
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return const_iterator(*this, 0);
+    }
+
+    iterator end() noexcept
+    {
+        return iterator(*this, static_cast<difference_type>(size()));
+    }
+
+    const_iterator end() const noexcept
+    {
+        return const_iterator(*this, static_cast<difference_type>(size()));
+    }
+
+    const_iterator cbegin() const noexcept
+    {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return end();
+    }
+
+    reverse_iterator rbegin() noexcept
+    {
+        return reverse_iterator(end());
+    }
+
+    const_reverse_iterator rbegin() const noexcept
+    {
+        return const_reverse_iterator(end());
+    }
+
+    reverse_iterator rend() noexcept
+    {
+        return reverse_iterator(begin());
+    }
+
+    const_reverse_iterator rend() const noexcept
+    {
+        return const_reverse_iterator(begin());
+    }
+
+    const_reverse_iterator crbegin() const noexcept
+    {
+        return rbegin();
+    }
+
+    const_reverse_iterator crend() const noexcept
+    {
+        return rend();
+    }
+
+    size_type size() const noexcept
+    {
+        return ends_.size();
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return ends_.empty();
+    }
+
+    size_type max_size() const noexcept
+    {
+        return ends_.max_size();
+    }
+
+    reference operator[](size_type pos) noexcept
+    {
+        assert(pos < size());
+        return reference(*this, pos);
+    }
+
+    const_reference operator[](size_type pos) const noexcept
+    {
+        assert(pos < size());
+        return const_reference(*this, pos);
+    }
+
+    reference front() noexcept
+    {
+        return (*this)[0];
+    }
+
+    const_reference front() const noexcept
+    {
+        return (*this)[0];
+    }
+
+    reference back() noexcept
+    {
+        return (*this)[size() - 1];
+    }
+
+    const_reference back() const noexcept
+    {
+        return (*this)[size() - 1];
+    }
+
+    // Returns the number of the values of all records
+    size_type value_count() const noexcept
+    {
+        return values_.size();
+    }
+
+    // Inserts an empty record
+    iterator emplace(const_iterator position)
+    {
+        const auto i = static_cast<size_type>(position.index());
+        ends_.insert(ends_.cbegin() + i, begin_of(i));          // throw
+        return iterator(*this, position.index());
+    }
+
+    // Inserts a record which has n copies of value
+    iterator emplace(const_iterator position, size_type n, const Value& value)
+    {
+        return emplace_record(position, [n, &value](auto& values, auto p) {
+            values.insert(p, n, value);
+        });                                                     // throw
+    }
+
+    // Inserts a record which has copies of the values in [first, last)
+    template <class InputIterator,
+        std::enable_if_t<!std::is_integral_v<InputIterator>>* = nullptr>
+    iterator emplace(const_iterator position,
+                     InputIterator first, InputIterator last)
+    {
+        return emplace_record(position, [first, last](auto& values, auto p) {
+            values.insert(p, first, last);
+        });                                                     // throw
+    }
+
+    template <class... Args>
+    reference emplace_back(Args&&... args)
+    {
+        return *emplace(cend(), std::forward<Args>(args)...);   // throw
+    }
+
+    iterator erase(const_iterator position) noexcept
+    {
+        return erase(position, position + 1);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) noexcept
+    {
+        const auto i = static_cast<size_type>(first.index());
+        const auto j = static_cast<size_type>(last.index());
+        if (i < j) {
+            const auto b = begin_of(i);
+            const auto e = ends_[j - 1];
+            values_.erase(values_.cbegin() + b, values_.cbegin() + e);
+            ends_.erase(ends_.cbegin() + i, ends_.cbegin() + j);
+            for (auto k = i; k < ends_.size(); ++k) {
+                ends_[k] -= e - b;
+            }
+        }
+        return iterator(*this, first.index());
+    }
+
+    void pop_back() noexcept
+    {
+        assert(!empty());
+        erase(cend() - 1);
+    }
+
+    void resize(size_type n)
+    {
+        if (n < size()) {
+            erase(cbegin() + n, cend());
+        } else {
+            ends_.resize(n, values_.size());                    // throw
+        }
+    }
+
+    void clear() noexcept
+    {
+        values_.clear();
+        ends_.clear();
+    }
+
+    void reserve(size_type n)
+    {
+        ends_.reserve(n);                                       // throw
+    }
+
+    void reserve_values(size_type n)
+    {
+        values_.reserve(n);                                     // throw
+    }
+
+    void shrink_to_fit()
+    {
+        values_.shrink_to_fit();
+        ends_.shrink_to_fit();
+    }
+
+    void swap(basic_flat_stored_content& other) noexcept
+    {
+        values_.swap(other.values_);
+        ends_.swap(other.ends_);
+    }
+
+    // Appends copies of all records of other at the end; has no effects if an
+    // exception is thrown
+    template <class OtherValue, class OtherAllocator>
+    void append(const basic_flat_stored_content<OtherValue, OtherAllocator>&
+        other)
+    {
+        const auto value_base = values_.size();
+        const auto record_base = ends_.size();
+        ends_.reserve(record_base + other.ends_.size());        // throw
+        values_.insert(values_.cend(),
+            other.values_.cbegin(), other.values_.cend());      // throw
+        for (const auto e : other.ends_) {
+            ends_.push_back(value_base + e);
+        }
+    }
+
+private:
+    size_type begin_of(size_type i) const noexcept
+    {
+        return (i == 0) ? 0 : ends_[i - 1];
+    }
+
+    template <class F>
+    iterator emplace_record(const_iterator position, F f)
+    {
+        const auto i = static_cast<size_type>(position.index());
+        const auto b = begin_of(i);
+        const auto e = ends_.insert(ends_.cbegin() + i, b);     // throw
+        const auto n0 = values_.size();
+        try {
+            f(values_, values_.cbegin() + b);                   // throw
+        } catch (...) {
+            ends_.erase(e);
+            throw;
+        }
+        const auto n = values_.size() - n0;
+        for (auto k = i; k < ends_.size(); ++k) {
+            ends_[k] += n;
+        }
+        return iterator(*this, position.index());
+    }
+
+    template <class F>
+    Value* insert_values(size_type i, const Value* position, F f)
+    {
+        const auto n0 = values_.size();
+        const auto p = f(values_, values_.cbegin()
+            + (position - static_cast<const Value*>(values_.data())));
+                                                                // throw
+        const auto n = values_.size() - n0;
+        for (auto k = i; k < ends_.size(); ++k) {
+            ends_[k] += n;
+        }
+        return values_.data() + (p - values_.begin());
+    }
+
+    Value* erase_values(size_type i, const Value* first, const Value* last)
+        noexcept
+    {
+        const Value* const d = values_.data();
+        const auto p = values_.erase(
+            values_.cbegin() + (first - d), values_.cbegin() + (last - d));
+        const auto n = static_cast<size_type>(last - first);
+        for (auto k = i; k < ends_.size(); ++k) {
+            ends_[k] -= n;
+        }
+        return values_.data() + (p - values_.begin());
+    }
+};
+
+template <class Value, class Allocator>
+void swap(basic_flat_stored_content<Value, Allocator>& left,
+          basic_flat_stored_content<Value, Allocator>& right) noexcept
+{
+    left.swap(right);
+}
+
+// A sequence of records like basic_flat_stored_content, except that it packs
+// each value into 64 bits, which are the index of one of the anchor pointers
+// it keeps, the offset of the value from the anchor and the length of the
+// value; values and records are accessed through proxies
+template <class Value, class Allocator = std::allocator<Value>>
+class basic_compact_stored_content
+{
+    using at_t = std::allocator_traits<Allocator>;
+    using sa_t = typename at_t::template rebind_alloc<std::size_t>;
+    using ca_t = typename at_t::template rebind_alloc<std::uint64_t>;
+    using vp_t = typename Value::pointer;
+    using pa_t = typename at_t::template rebind_alloc<vp_t>;
+    using ia_t = typename at_t::template rebind_alloc<std::uint32_t>;
+
+    static constexpr unsigned anchor_bits = 20;
+    static constexpr unsigned offset_bits = 24;
+    static constexpr unsigned length_bits = 20;
+    static_assert(anchor_bits + offset_bits + length_bits == 64);
+
+    template <class OtherValue, class OtherAllocator>
+    friend class basic_compact_stored_content;
+
+public:
+    using allocator_type  = Allocator;
+    using size_type       = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    // The longest value which can be held
+    static constexpr size_type max_value_size =
+        (size_type(1) << length_bits) - 1;
+
+    // Proxy of a value which reads and writes the value in the content
+    class value_reference
+    {
+        basic_compact_stored_content* content_;
+        size_type index_;
+
+    public:
+        value_reference(basic_compact_stored_content& content,
+                        size_type index) noexcept :
+            content_(std::addressof(content)), index_(index)
+        {}
+
+        value_reference(const value_reference&) = default;
+
+        value_reference& operator=(const value_reference& other)
+        {
+            return *this = other.get();                         // throw
+        }
+
+        value_reference& operator=(const Value& value)
+        {
+            content_->cells_[index_] = content_->encode(value); // throw
+            return *this;
+        }
+
+        Value get() const noexcept
+        {
+            return content_->decode(content_->cells_[index_]);
+        }
+
+        operator Value() const noexcept
+        {
+            return get();
+        }
+
+        friend bool operator==(const value_reference& left,
+                               const value_reference& right) noexcept
+        {
+            return left.get() == right.get();
+        }
+
+        friend bool operator!=(const value_reference& left,
+                               const value_reference& right) noexcept
+        {
+            return left.get() != right.get();
+        }
+
+        template <class Other>
+        friend auto operator==(const value_reference& left,
+                               const Other& right)
+         -> decltype(std::declval<const Value&>() == right)
+        {
+            return left.get() == right;
+        }
+
+        template <class Other>
+        friend auto operator==(const Other& left,
+                               const value_reference& right)
+         -> decltype(left == std::declval<const Value&>())
+        {
+            return left == right.get();
+        }
+
+        template <class Other>
+        friend auto operator!=(const value_reference& left,
+                               const Other& right)
+         -> decltype(std::declval<const Value&>() != right)
+        {
+            return left.get() != right;
+        }
+
+        template <class Other>
+        friend auto operator!=(const Other& left,
+                               const value_reference& right)
+         -> decltype(left != std::declval<const Value&>())
+        {
+            return left != right.get();
+        }
+
+        template <class Tr>
+        friend auto operator<<(
+            std::basic_ostream<typename Value::value_type, Tr>& os,
+            const value_reference& o)
+         -> decltype(os)
+        {
+            return os << o.get();
+        }
+    };
+
+    // Copy of a value which is read from the content
+    class const_value : public Value
+    {
+    public:
+        const_value(const basic_compact_stored_content& content,
+                    size_type index) noexcept :
+            Value(content.decode(content.cells_[index]))
+        {}
+
+        const_value(const value_reference& other) noexcept :
+            Value(other.get())
+        {}
+    };
+
+    template <bool Const>
+    class basic_record
+    {
+        using content_t = std::conditional_t<Const,
+            const basic_compact_stored_content, basic_compact_stored_content>;
+
+    public:
+        using value_type      = Value;
+        using size_type       = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference       =
+            std::conditional_t<Const, const_value, value_reference>;
+        using const_reference = const_value;
+        using iterator        =
+            detail::stored::indexed_iterator<content_t, reference>;
+        using const_iterator  = detail::stored::indexed_iterator<
+            const basic_compact_stored_content, const_value>;
+        using reverse_iterator       = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    private:
+        content_t* content_;
+        size_type index_;
+
+        friend class basic_compact_stored_content;
+
+        template <bool> friend class basic_record;
+
+    public:
+        basic_record(content_t& content, size_type index) noexcept :
+            content_(std::addressof(content)), index_(index)
+        {}
+
+        template <bool OtherConst,
+                  std::enable_if_t<Const && !OtherConst>* = nullptr>
+        basic_record(const basic_record<OtherConst>& other) noexcept :
+            content_(other.content_), index_(other.index_)
+        {}
+
+        iterator begin() const noexcept
+        {
+            return iterator(*content_, cell_index(content_->begin_of(index_)));
+        }
+
+        iterator end() const noexcept
+        {
+            return iterator(*content_, cell_index(content_->ends_[index_]));
+        }
+
+        const_iterator cbegin() const noexcept
+        {
+            return begin();
+        }
+
+        const_iterator cend() const noexcept
+        {
+            return end();
+        }
+
+        reverse_iterator rbegin() const noexcept
+        {
+            return reverse_iterator(end());
+        }
+
+        reverse_iterator rend() const noexcept
+        {
+            return reverse_iterator(begin());
+        }
+
+        const_reverse_iterator crbegin() const noexcept
+        {
+            return rbegin();
+        }
+
+        const_reverse_iterator crend() const noexcept
+        {
+            return rend();
+        }
+
+        size_type size() const noexcept
+        {
+            return content_->ends_[index_] - content_->begin_of(index_);
+        }
+
+        [[nodiscard]] bool empty() const noexcept
+        {
+            return size() == 0;
+        }
+
+        reference operator[](size_type pos) const noexcept
+        {
+            assert(pos < size());
+            return begin()[pos];
+        }
+
+        reference front() const noexcept
+        {
+            assert(!empty());
+            return *begin();
+        }
+
+        reference back() const noexcept
+        {
+            assert(!empty());
+            return end()[-1];
+        }
+
+        template <class... Args>
+        iterator emplace(const_iterator position, Args&&... args)
+        {
+            return insert(position, 1, Value(std::forward<Args>(args)...));
+                                                                // throw
+        }
+
+        iterator insert(const_iterator position, const Value& value)
+        {
+            return insert(position, 1, value);                  // throw
+        }
+
+        iterator insert(const_iterator position, size_type n,
+                        const Value& value)
+        {
+            const auto c = content_->encode(value);             // throw
+            return content_->insert_cells(index_, position,
+                [n, c](auto& cells, auto p) {
+                    cells.insert(p, n, c);
+                });                                             // throw
+        }
+
+        template <class InputIterator,
+            std::enable_if_t<!std::is_integral_v<InputIterator>>* = nullptr>
+        iterator insert(const_iterator position,
+                        InputIterator first, InputIterator last)
+        {
+            return content_->insert_cells(index_, position,
+                [this, first, last](auto& cells, auto p) {
+                    content_->encode_insert(cells, p, first, last);
+                });                                             // throw
+        }
+
+        template <class... Args>
+        reference emplace_back(Args&&... args)
+        {
+            return *emplace(cend(), std::forward<Args>(args)...);   // throw
+        }
+
+        void push_back(const Value& value)
+        {
+            insert(cend(), value);                              // throw
+        }
+
+        iterator erase(const_iterator position) noexcept
+        {
+            return erase(position, position + 1);
+        }
+
+        iterator erase(const_iterator first, const_iterator last) noexcept
+        {
+            const auto b = first.index();
+            const auto e = last.index();
+            content_->cells_.erase(content_->cells_.cbegin() + b,
+                                   content_->cells_.cbegin() + e);
+            for (auto k = index_; k < content_->ends_.size(); ++k) {
+                content_->ends_[k] -= e - b;
+            }
+            return iterator(*content_, cell_index(b));
+        }
+
+        void pop_back() noexcept
+        {
+            assert(!empty());
+            erase(cend() - 1);
+        }
+
+        void clear() noexcept
+        {
+            erase(cbegin(), cend());
+        }
+
+        void resize(size_type n)
+        {
+            resize(n, Value());                                 // throw
+        }
+
+        void resize(size_type n, const Value& value)
+        {
+            const auto s = size();
+            if (n < s) {
+                erase(cbegin() + n, cend());
+            } else {
+                insert(cend(), n - s, value);                   // throw
+            }
+        }
+
+    private:
+        static difference_type cell_index(size_type i) noexcept
+        {
+            return static_cast<difference_type>(i);
+        }
+    };
+
+    using record       = basic_record<false>;
+    using const_record = basic_record<true>;
+
+    using value_type      = record;
+    using reference       = record;
+    using const_reference = const_record;
+    using iterator        = detail::stored::indexed_iterator<
+        basic_compact_stored_content, record>;
+    using const_iterator  = detail::stored::indexed_iterator<
+        const basic_compact_stored_content, const_record>;
+    using reverse_iterator       = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+private:
+    // Packed values of all records
+    std::vector<std::uint64_t, ca_t> cells_;
+    // ends_[i] is the index of the past-the-end cell of the i-th record in
+    // cells_
+    std::vector<size_type, sa_t> ends_;
+    // Anchors in the order of their creation, whose indices are packed into
+    // the cells
+    std::vector<vp_t, pa_t> anchors_;
+    // Indices of the anchors sorted by their addresses
+    std::vector<std::uint32_t, ia_t> sorted_anchors_;
+    // Index of the anchor most recently used, or anchors_.size() if none
+    std::uint32_t last_anchor_;
+
+public:
+    basic_compact_stored_content() :
+        basic_compact_stored_content(Allocator())
+    {}
+
+    explicit basic_compact_stored_content(const Allocator& alloc) :
+        cells_(ca_t(alloc)), ends_(sa_t(alloc)), anchors_(pa_t(alloc)),
+        sorted_anchors_(ia_t(alloc)), last_anchor_(0)
+    {}
+
+    explicit basic_compact_stored_content(size_type n,
+        const Allocator& alloc = Allocator()) :
+        cells_(ca_t(alloc)), ends_(n, 0, sa_t(alloc)), anchors_(pa_t(alloc)),
+        sorted_anchors_(ia_t(alloc)), last_anchor_(0)
+    {}
+
+    basic_compact_stored_content(
+        const basic_compact_stored_content&) = default;
+    basic_compact_stored_content(
+        basic_compact_stored_content&&) = default;
+    ~basic_compact_stored_content() = default;
+    basic_compact_stored_content& operator=(
+        const basic_compact_stored_content&) = default;
+    basic_compact_stored_content& operator=(
+        basic_compact_stored_content&&) = default;
+
+    allocator_type get_allocator() const noexcept
+    {
+        return allocator_type(cells_.get_allocator());
+    }
+
+    iterator begin() noexcept
+    {
+        return iterator(*this, 0);
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return const_iterator(*this, 0);
+    }
+
+    iterator end() noexcept
+    {
+        return iterator(*this, static_cast<difference_type>(size()));
+    }
+
+    const_iterator end() const noexcept
+    {
+        return const_iterator(*this, static_cast<difference_type>(size()));
+    }
+
+    const_iterator cbegin() const noexcept
+    {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return end();
+    }
+
+    reverse_iterator rbegin() noexcept
+    {
+        return reverse_iterator(end());
+    }
+
+    const_reverse_iterator rbegin() const noexcept
+    {
+        return const_reverse_iterator(end());
+    }
+
+    reverse_iterator rend() noexcept
+    {
+        return reverse_iterator(begin());
+    }
+
+    const_reverse_iterator rend() const noexcept
+    {
+        return const_reverse_iterator(begin());
+    }
+
+    const_reverse_iterator crbegin() const noexcept
+    {
+        return rbegin();
+    }
+
+    const_reverse_iterator crend() const noexcept
+    {
+        return rend();
+    }
+
+    size_type size() const noexcept
+    {
+        return ends_.size();
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return ends_.empty();
+    }
+
+    size_type max_size() const noexcept
+    {
+        return ends_.max_size();
+    }
+
+    reference operator[](size_type pos) noexcept
+    {
+        assert(pos < size());
+        return reference(*this, pos);
+    }
+
+    const_reference operator[](size_type pos) const noexcept
+    {
+        assert(pos < size());
+        return const_reference(*this, pos);
+    }
+
+    reference front() noexcept
+    {
+        return (*this)[0];
+    }
+
+    const_reference front() const noexcept
+    {
+        return (*this)[0];
+    }
+
+    reference back() noexcept
+    {
+        return (*this)[size() - 1];
+    }
+
+    const_reference back() const noexcept
+    {
+        return (*this)[size() - 1];
+    }
+
+    // Returns the number of the values of all records
+    size_type value_count() const noexcept
+    {
+        return cells_.size();
+    }
+
+    // Inserts an empty record
+    iterator emplace(const_iterator position)
+    {
+        const auto i = position.index();
+        ends_.insert(ends_.cbegin() + i, begin_of(i));          // throw
+        return iterator(*this, static_cast<difference_type>(i));
+    }
+
+    // Inserts a record which has n copies of value
+    iterator emplace(const_iterator position, size_type n, const Value& value)
+    {
+        const auto c = encode(value);                           // throw
+        return emplace_record(position, [n, c](auto& cells, auto p) {
+            cells.insert(p, n, c);
+        });                                                     // throw
+    }
+
+    // Inserts a record which has copies of the values in [first, last)
+    template <class InputIterator,
+        std::enable_if_t<!std::is_integral_v<InputIterator>>* = nullptr>
+    iterator emplace(const_iterator position,
+                     InputIterator first, InputIterator last)
+    {
+        return emplace_record(position,
+            [this, first, last](auto& cells, auto p) {
+                encode_insert(cells, p, first, last);
+            });                                                 // throw
+    }
+
+    template <class... Args>
+    reference emplace_back(Args&&... args)
+    {
+        return *emplace(cend(), std::forward<Args>(args)...);   // throw
+    }
+
+    iterator erase(const_iterator position) noexcept
+    {
+        return erase(position, position + 1);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) noexcept
+    {
+        const auto i = first.index();
+        const auto j = last.index();
+        if (i < j) {
+            const auto b = begin_of(i);
+            const auto e = ends_[j - 1];
+            cells_.erase(cells_.cbegin() + b, cells_.cbegin() + e);
+            ends_.erase(ends_.cbegin() + i, ends_.cbegin() + j);
+            for (auto k = i; k < ends_.size(); ++k) {
+                ends_[k] -= e - b;
+            }
+        }
+        return iterator(*this, static_cast<difference_type>(i));
+    }
+
+    void pop_back() noexcept
+    {
+        assert(!empty());
+        erase(cend() - 1);
+    }
+
+    void resize(size_type n)
+    {
+        if (n < size()) {
+            erase(cbegin() + n, cend());
+        } else {
+            ends_.resize(n, cells_.size());                     // throw
+        }
+    }
+
+    void clear() noexcept
+    {
+        cells_.clear();
+        ends_.clear();
+        anchors_.clear();
+        sorted_anchors_.clear();
+        last_anchor_ = 0;
+    }
+
+    void reserve(size_type n)
+    {
+        ends_.reserve(n);                                       // throw
+    }
+
+    void reserve_values(size_type n)
+    {
+        cells_.reserve(n);                                      // throw
+    }
+
+    void shrink_to_fit()
+    {
+        cells_.shrink_to_fit();
+        ends_.shrink_to_fit();
+        anchors_.shrink_to_fit();
+        sorted_anchors_.shrink_to_fit();
+    }
+
+    void swap(basic_compact_stored_content& other) noexcept
+    {
+        cells_.swap(other.cells_);
+        ends_.swap(other.ends_);
+        anchors_.swap(other.anchors_);
+        sorted_anchors_.swap(other.sorted_anchors_);
+        std::swap(last_anchor_, other.last_anchor_);
+    }
+
+    // Appends copies of all records of other at the end; has no effects
+    // other than creation of anchors if an exception is thrown
+    template <class OtherValue, class OtherAllocator>
+    void append(const basic_compact_stored_content<OtherValue, OtherAllocator>&
+        other)
+    {
+        const auto cell_base = cells_.size();
+        ends_.reserve(ends_.size() + other.ends_.size());       // throw
+        cells_.reserve(cell_base + other.cells_.size());        // throw
+        try {
+            for (const auto c : other.cells_) {
+                cells_.push_back(encode(Value(other.decode(c))));   // throw
+            }
+        } catch (...) {
+            cells_.resize(cell_base);
+            throw;
+        }
+        for (const auto e : other.ends_) {
+            ends_.push_back(cell_base + e);
+        }
+    }
+
+private:
+    size_type begin_of(size_type i) const noexcept
+    {
+        return (i == 0) ? 0 : ends_[i - 1];
+    }
+
+    static std::uintptr_t address_of(vp_t p) noexcept
+    {
+        return reinterpret_cast<std::uintptr_t>(static_cast<const void*>(p));
+    }
+
+    // Returns the index of an anchor from which p lies within the range of
+    // offsets, creating a new one if needed
+    std::uint32_t secure_anchor(vp_t p)
+    {
+        using ch_t = typename Value::value_type;
+        constexpr std::uintptr_t range =
+            (std::uintptr_t(1) << offset_bits) * sizeof(ch_t);
+        const auto a = address_of(p);
+        const auto covers = [this, a, range](std::uint32_t k) {
+            const auto ak = address_of(anchors_[k]);
+            return (ak <= a) && (a - ak < range);
+        };
+
+        if ((last_anchor_ < anchors_.size()) && covers(last_anchor_)) {
+            return last_anchor_;
+        }
+        const auto i = std::upper_bound(
+            sorted_anchors_.cbegin(), sorted_anchors_.cend(), a,
+            [this](std::uintptr_t x, std::uint32_t k) {
+                return x < address_of(anchors_[k]);
+            });
+        if ((i != sorted_anchors_.cbegin()) && covers(*std::prev(i))) {
+            last_anchor_ = *std::prev(i);
+            return last_anchor_;
+        }
+
+        if (anchors_.size() >= (std::size_t(1) << anchor_bits)) {
+#ifdef COMMATA_EXCEPTIONS_ENABLED
+            throw std::length_error(
+                "Too many anchors for commata::basic_compact_stored_content");
+#else
+            std::abort();
+#endif
+        }
+        const auto k = static_cast<std::uint32_t>(anchors_.size());
+        const auto at = i - sorted_anchors_.cbegin();
+        anchors_.reserve(k + 1);                                // throw
+        sorted_anchors_.reserve(k + 1);                         // throw
+        anchors_.push_back(p);
+        sorted_anchors_.insert(sorted_anchors_.cbegin() + at, k);
+        last_anchor_ = k;
+        return k;
+    }
+
+    std::uint64_t encode(const Value& value)
+    {
+        const auto n = value.size();
+        if (n == 0) {
+            return 0;
+        } else if (n > max_value_size) {
+#ifdef COMMATA_EXCEPTIONS_ENABLED
+            throw std::length_error(
+                "Too long value for commata::basic_compact_stored_content");
+#else
+            std::abort();
+#endif
+        }
+        const vp_t p = const_cast<vp_t>(value.data());
+        const auto k = secure_anchor(p);                        // throw
+        const auto offset = (address_of(p) - address_of(anchors_[k]))
+                          / sizeof(typename Value::value_type);
+        return (std::uint64_t(k) << (offset_bits + length_bits))
+             | (std::uint64_t(offset) << length_bits)
+             | std::uint64_t(n);
+    }
+
+    Value decode(std::uint64_t c) const noexcept
+    {
+        constexpr std::uint64_t length_mask =
+            (std::uint64_t(1) << length_bits) - 1;
+        constexpr std::uint64_t offset_mask =
+            (std::uint64_t(1) << offset_bits) - 1;
+        const auto n = static_cast<size_type>(c & length_mask);
+        if (n == 0) {
+            return Value();
+        }
+        const auto offset =
+            static_cast<std::uintptr_t>((c >> length_bits) & offset_mask);
+        const auto k = static_cast<size_type>(
+            c >> (offset_bits + length_bits));
+        const auto p = reinterpret_cast<vp_t>(address_of(anchors_[k])
+            + offset * sizeof(typename Value::value_type));
+        return Value(p, p + n);
+    }
+
+    // Inserts the packed values in [first, last) into cells before p
+    template <class InputIterator>
+    void encode_insert(std::vector<std::uint64_t, ca_t>& cells,
+        typename std::vector<std::uint64_t, ca_t>::const_iterator p,
+        InputIterator first, InputIterator last)
+    {
+        std::vector<std::uint64_t, ca_t> packed(cells.get_allocator());
+        for (; first != last; ++first) {
+            packed.push_back(encode(*first));                   // throw
+        }
+        cells.insert(p, packed.cbegin(), packed.cend());        // throw
+    }
+
+    template <class F>
+    iterator emplace_record(const_iterator position, F f)
+    {
+        const auto i = position.index();
+        const auto b = begin_of(i);
+        const auto e = ends_.insert(ends_.cbegin() + i, b);     // throw
+        const auto n0 = cells_.size();
+        try {
+            f(cells_, cells_.cbegin() + b);                     // throw
+        } catch (...) {
+            ends_.erase(e);
+            throw;
+        }
+        const auto n = cells_.size() - n0;
+        for (auto k = i; k < ends_.size(); ++k) {
+            ends_[k] += n;
+        }
+        return iterator(*this, static_cast<difference_type>(i));
+    }
+
+    template <class F>
+    typename record::iterator insert_cells(size_type i,
+        typename record::const_iterator position, F f)
+    {
+        const auto n0 = cells_.size();
+        f(cells_, cells_.cbegin() + position.index());          // throw
+        const auto n = cells_.size() - n0;
+        for (auto k = i; k < ends_.size(); ++k) {
+            ends_[k] += n;
+        }
+        return typename record::iterator(*this,
+            static_cast<difference_type>(position.index()));
+    }
+};
+
+template <class Value, class Allocator>
+void swap(basic_compact_stored_content<Value, Allocator>& left,
+          basic_compact_stored_content<Value, Allocator>& right) noexcept
+{
+    left.swap(right);
+}
+
+namespace detail::stored {
+
 template <class T>
 auto select_allocator(const T&, const T& r, std::true_type)
 {
@@ -1105,7 +2610,8 @@ constexpr bool is_equatable_with_v =
     decltype(is_equatable_with_impl::check<L, R>(nullptr, nullptr))::value;
 
 template <class Container>
-static void reserve(Container&, typename Container::size_type)
+static void reserve(Container&&,
+    typename std::remove_reference_t<Container>::size_type)
 {}
 
 template <class... Ts>
@@ -1115,6 +2621,20 @@ static void reserve(std::vector<Ts...>& c,
     c.reserve(n);
 }
 
+template <class... Ts>
+static void reserve(basic_flat_stored_content<Ts...>& c,
+    typename basic_flat_stored_content<Ts...>::size_type n)
+{
+    c.reserve(n);
+}
+
+template <class... Ts>
+static void reserve(basic_compact_stored_content<Ts...>& c,
+    typename basic_compact_stored_content<Ts...>::size_type n)
+{
+    c.reserve(n);
+}
+
 } // end detail::stored
 
 template <class Content, class Allocator = std::allocator<Content>>
@@ -1300,12 +2820,13 @@ public:
         return *records_;
     }
 
-    record_type& operator[](size_type record_index)
+    typename content_type::reference operator[](size_type record_index)
     {
         return content()[record_index];
     }
 
-    const record_type& operator[](size_type record_index) const
+    typename content_type::const_reference operator[](
+        size_type record_index) const
     {
         return content()[record_index];
     }
@@ -1501,6 +3022,22 @@ public:
                              std::begin(new_value), std::end(new_value));
     }
 
+    // Rewrites a value which a content hands out as a proxy object rather
+    // than as a reference
+    template <class Proxy, class... Args>
+    auto rewrite_value(Proxy&& value, Args&&... args)
+     -> std::enable_if_t<
+            !std::is_reference_v<typename record_type::reference>
+         && std::is_same_v<std::decay_t<Proxy>,
+                           typename record_type::reference>,
+            value_type>
+    {
+        value_type v = value;
+        rewrite_value(v, std::forward<Args>(args)...);  // throw
+        value = v;                                      // throw
+        return v;
+    }
+
     template <class... Args>
     [[nodiscard]] value_type import_value(Args&&... args)
     {
@@ -1873,6 +3410,26 @@ void append_content(
     l.splice(l.cend(), r);
 }
 
+// append_content: flat-contents version
+template <class ValueL, class AllocatorL, class ValueR, class AllocatorR>
+void append_content(
+    basic_flat_stored_content<ValueL, AllocatorL>& l,
+    basic_flat_stored_content<ValueR, AllocatorR>&& r)
+{
+    l.append(r);    // throw
+    r.clear();
+}
+
+// append_content: compact-contents version
+template <class ValueL, class AllocatorL, class ValueR, class AllocatorR>
+void append_content(
+    basic_compact_stored_content<ValueL, AllocatorL>& l,
+    basic_compact_stored_content<ValueR, AllocatorR>&& r)
+{
+    l.append(r);    // throw
+    r.clear();
+}
+
 template <class ContentL, class AllocatorL, class TableR>
 basic_stored_table<ContentL, AllocatorL> plus_impl(
     const basic_stored_table<ContentL, AllocatorL>& left, TableR&& right)
@@ -1943,10 +3500,29 @@ using cstored_table =
 using cwstored_table =
     basic_stored_table<std::deque<std::vector<cwstored_value>>>;
 
+using flat_stored_table =
+    basic_stored_table<basic_flat_stored_content<stored_value>>;
+using wflat_stored_table =
+    basic_stored_table<basic_flat_stored_content<wstored_value>>;
+using cflat_stored_table =
+    basic_stored_table<basic_flat_stored_content<cstored_value>>;
+using cwflat_stored_table =
+    basic_stored_table<basic_flat_stored_content<cwstored_value>>;
+
+using compact_stored_table =
+    basic_stored_table<basic_compact_stored_content<stored_value>>;
+using wcompact_stored_table =
+    basic_stored_table<basic_compact_stored_content<wstored_value>>;
+using ccompact_stored_table =
+    basic_stored_table<basic_compact_stored_content<cstored_value>>;
+using cwcompact_stored_table =
+    basic_stored_table<basic_compact_stored_content<cwstored_value>>;
+
 enum class stored_table_builder_option : std::uint_fast8_t
 {
     none = 0,
-    transpose = 1
+    transpose = 1,
+    intern = 2
 };
 
 constexpr inline stored_table_builder_option operator|(
@@ -2021,7 +3597,7 @@ struct arrange_as_is
 
     void new_value(Content& content, char_type* first, char_type* last) const
     {
-        auto& back = *content.rbegin();
+        auto&& back = *content.rbegin();
         back.emplace(back.cend(), first, last);     // throw
     }
 };
@@ -2075,6 +3651,15 @@ using arrange = std::conditional_t<
         != stored_table_builder_option(0),
     arrange_transposing<Content>, arrange_as_is<Content>>;
 
+// Stands for the set of the interned values of a builder which does not
+// intern values
+struct no_interned_values
+{
+    template <class Allocator>
+    explicit no_interned_values(const Allocator&) noexcept
+    {}
+};
+
 template <class StoredTable>
 struct end_record_handler
 {
@@ -2138,6 +3723,24 @@ private:
     using ph_t = typename std::allocator_traits<Allocator>::
         template rebind_traits<h_t>::pointer;
 
+    using value_t = typename table_type::value_type;
+    using va_t = typename std::allocator_traits<Allocator>::
+        template rebind_alloc<value_t>;
+
+    static constexpr bool interns =
+        (Options & stored_table_builder_option::intern)
+            != stored_table_builder_option(0);
+    static_assert(!interns
+        || std::is_const_v<
+            std::remove_reference_t<typename value_t::reference>>,
+        "stored_table_builder_option::intern requires values "
+        "whose characters are const");
+
+    using interned_t = std::conditional_t<interns,
+        std::unordered_set<value_t,
+            std::hash<value_t>, std::equal_to<value_t>, va_t>,
+        detail::stored::no_interned_values>;
+
 private:
     char_type* current_buffer_holder_;
     char_type* current_buffer_;
@@ -2150,6 +3753,10 @@ private:
 
     ph_t end_record_;
 
+    // Canonical copies of the values which have been read, or an empty
+    // object if the values are not interned
+    interned_t interned_;
+
 public:
     explicit stored_table_builder(table_type& table,
                                   std::size_t max_record_num = 0) :
@@ -2160,7 +3767,8 @@ public:
             allocate_construct(
                 [remaining = max_record_num](table_type&) mutable {
                     return --remaining > 0;
-                }) : nullptr)
+                }) : nullptr),
+        interned_(va_t(table.get_allocator()))
     {}
 
     template <class E,
@@ -2170,10 +3778,12 @@ public:
         detail::stored::arrange<Content, Options>(table.content()),
         current_buffer_holder_(nullptr), current_buffer_(nullptr),
         field_begin_(nullptr), table_(std::addressof(table)),
-        end_record_(allocate_construct(std::forward<E>(e)))
+        end_record_(allocate_construct(std::forward<E>(e))),
+        interned_(va_t(table.get_allocator()))
     {}
 
-    stored_table_builder(stored_table_builder&& other) noexcept :
+    stored_table_builder(stored_table_builder&& other)
+        noexcept(std::is_nothrow_move_constructible_v<interned_t>) :
         detail::stored::arrange<Content, Options>(other),
         current_buffer_holder_(std::exchange(other.current_buffer_holder_,
                                              nullptr)),
@@ -2181,7 +3791,8 @@ public:
         current_buffer_size_(other.current_buffer_size_),
         field_begin_(other.field_begin_), field_end_(other.field_end_),
         table_(other.table_),
-        end_record_(std::exchange(other.end_record_, nullptr))
+        end_record_(std::exchange(other.end_record_, nullptr)),
+        interned_(std::move(other.interned_))
     {}
 
     ~stored_table_builder()
@@ -2217,6 +3828,18 @@ private:
         detail::destroy_deallocate_g_dynamic(table_->get_allocator(), p);
     }
 
+    // Returns the canonical copy of value in the store of the table,
+    // importing value into the store if it is the first occurrence
+    value_t intern(const value_t& value)
+    {
+        const auto i = interned_.find(value);
+        if (i != interned_.cend()) {
+            return *i;
+        }
+        return *interned_.insert(table_->import_value(value)).first;
+                                                                // throw
+    }
+
 public:
     void start_record(char_type* /*record_begin*/)
     {
@@ -2238,6 +3861,18 @@ public:
     {
         update(first, last);
         table_type::traits_type::assign(*field_end_, char_type());
+        if constexpr (interns) {
+            // The value is not committed to the store as is, so the current
+            // buffer stays with us to be reused
+            const auto v = intern(value_t(field_begin_, field_end_)); // throw
+            // The characters of v are in a buffer of the store, which are
+            // not const in themselves
+            this->new_value(table_->content(),
+                const_cast<char_type*>(v.cbegin()),
+                const_cast<char_type*>(v.cend()));                    // throw
+            field_begin_ = nullptr;
+            return;
+        }
         if (current_buffer_holder_) {
             const auto cbh = std::exchange(current_buffer_holder_, nullptr);
             table_->add_buffer(cbh, current_buffer_size_);    // throw
@@ -0,0 +1,338 @@
+/**
+ * These codes are licensed under the Unlicense.
+ * http://unlicense.org
+ */
+
+#ifndef COMMATA_GUARD_8713C09E_580B_4E89_B15E_69191CA73A0B
+#define COMMATA_GUARD_8713C09E_580B_4E89_B15E_69191CA73A0B
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "stored_table.hpp"
+
+namespace commata {
+
+// A hash index from the values of one column of a basic_stored_table to the
+// indices of the records which have them; distinct values occupy the slots
+// of an open-addressing hash table with linear probing, and the records
+// which share one value are chained in ascending order
+template <class Content, class Allocator>
+class stored_table_index
+{
+public:
+    using table_type  = basic_stored_table<Content, Allocator>;
+    using char_type   = typename table_type::char_type;
+    using traits_type = typename table_type::traits_type;
+    using key_type    = std::basic_string_view<char_type, traits_type>;
+    using size_type   = std::size_t;
+
+    static constexpr size_type npos = static_cast<size_type>(-1);
+
+private:
+    using value_t = typename table_type::value_type;
+
+    struct slot
+    {
+        value_t key;
+        std::size_t hash;
+        size_type first;    // npos if the slot is vacant
+        size_type last;
+    };
+
+    using at_t = std::allocator_traits<Allocator>;
+    using sa_t = typename at_t::template rebind_alloc<slot>;
+    using na_t = typename at_t::template rebind_alloc<size_type>;
+
+    // The initial number of the slots, which shall be a power of two
+    static constexpr size_type min_slot_count = 16;
+
+    table_type* table_;
+    size_type column_;
+
+    // Slots whose number is zero or a power of two
+    std::vector<slot, sa_t> slots_;
+    // next_[i] is the index of the record next to the i-th record which
+    // has the same value, or npos; its size is the number of the records
+    // which have been indexed
+    std::vector<size_type, na_t> next_;
+    // The number of the occupied slots
+    size_type key_count_;
+    // The number of the indexed records which have the column
+    size_type value_count_;
+
+public:
+    // Iterates over the indices of the records which have one value in the
+    // ascending order
+    class const_iterator
+    {
+        const stored_table_index* index_;
+        size_type i_;
+
+    public:
+        using value_type        = size_type;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const size_type*;
+        using reference         = const size_type&;
+        using iterator_category = std::forward_iterator_tag;
+
+        const_iterator() noexcept :
+            index_(nullptr), i_(npos)
+        {}
+
+        const_iterator(const stored_table_index& index, size_type i)
+            noexcept :
+            index_(std::addressof(index)), i_(i)
+        {}
+
+        reference operator*() const noexcept
+        {
+            assert(i_ != npos);
+            return i_;
+        }
+
+        pointer operator->() const noexcept
+        {
+            return std::addressof(**this);
+        }
+
+        const_iterator& operator++() noexcept
+        {
+            assert(i_ != npos);
+            i_ = index_->next_[i_];
+            return *this;
+        }
+
+        const_iterator operator++(int) noexcept
+        {
+            const auto copy(*this);
+            ++*this;
+            return copy;
+        }
+
+        friend bool operator==(const const_iterator& left,
+                               const const_iterator& right) noexcept
+        {
+            return left.i_ == right.i_;
+        }
+
+        friend bool operator!=(const const_iterator& left,
+                               const const_iterator& right) noexcept
+        {
+            return !(left == right);
+        }
+    };
+
+    using iterator = const_iterator;
+
+    stored_table_index(table_type& table, size_type column) :
+        table_(std::addressof(table)), column_(column),
+        slots_(sa_t(table.get_allocator())),
+        next_(na_t(table.get_allocator())),
+        key_count_(0), value_count_(0)
+    {
+        update();                                               // throw
+    }
+
+    stored_table_index(const stored_table_index&) = default;
+    stored_table_index(stored_table_index&&) = default;
+    ~stored_table_index() = default;
+    stored_table_index& operator=(const stored_table_index&) = default;
+    stored_table_index& operator=(stored_table_index&&) = default;
+
+    table_type& table() const noexcept
+    {
+        return *table_;
+    }
+
+    size_type column() const noexcept
+    {
+        return column_;
+    }
+
+    // Returns the number of the records which have been indexed
+    size_type record_count() const noexcept
+    {
+        return next_.size();
+    }
+
+    // Returns the number of the indexed records which have the column
+    size_type size() const noexcept
+    {
+        return value_count_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return value_count_ == 0;
+    }
+
+    // Returns the number of the distinct values
+    size_type key_count() const noexcept
+    {
+        return key_count_;
+    }
+
+    // Indexes the records appended to the table since the last call; the
+    // records which have been indexed shall not have been modified
+    void update()
+    {
+        const auto& c = table_->content();
+        const auto n = table_->size();
+        assert(n >= next_.size());
+        next_.reserve(n);                                       // throw
+        auto i = std::prev(c.cend(), n - next_.size());
+        for (; next_.size() < n; ++i) {
+            const auto& r = *i;
+            if (column_ < r.size()) {
+                const value_t v = *std::next(r.cbegin(), column_);
+                add(v);                                         // throw
+            } else {
+                next_.push_back(npos);
+            }
+        }
+    }
+
+    // Discards the index and then indexes all records of the table
+    void rebuild()
+    {
+        stored_table_index(*table_, column_).swap(*this);       // throw
+    }
+
+    // Returns the range of the indices of the records which have key
+    std::pair<const_iterator, const_iterator> equal_range(key_type key) const
+        noexcept
+    {
+        return { const_iterator(*this, find(key)),
+                 const_iterator(*this, npos) };
+    }
+
+    // Returns the index of the first record which has key, or npos
+    size_type find(key_type key) const noexcept
+    {
+        const auto s = find_slot(key, hash_of(key));
+        return (s == npos) ? npos : slots_[s].first;
+    }
+
+    size_type count(key_type key) const noexcept
+    {
+        const auto r = equal_range(key);
+        return static_cast<size_type>(std::distance(r.first, r.second));
+    }
+
+    bool contains(key_type key) const noexcept
+    {
+        return find(key) != npos;
+    }
+
+    void swap(stored_table_index& other) noexcept
+    {
+        using std::swap;
+        swap(table_, other.table_);
+        swap(column_, other.column_);
+        slots_.swap(other.slots_);
+        next_.swap(other.next_);
+        swap(key_count_, other.key_count_);
+        swap(value_count_, other.value_count_);
+    }
+
+private:
+    static std::size_t hash_of(key_type key) noexcept
+    {
+        // Agrees with std::hash<value_t>, which hashes the string view
+        return std::hash<key_type>()(key);
+    }
+
+    // Returns the index of the slot which holds key, or npos
+    size_type find_slot(key_type key, std::size_t hash) const noexcept
+    {
+        if (slots_.empty()) {
+            return npos;
+        }
+        const auto mask = slots_.size() - 1;
+        for (auto s = hash & mask; ; s = (s + 1) & mask) {
+            const auto& t = slots_[s];
+            if (t.first == npos) {
+                return npos;
+            } else if ((t.hash == hash) && (key_type(t.key) == key)) {
+                return s;
+            }
+        }
+    }
+
+    // Returns the index of the slot which holds key or of the vacant slot
+    // where key should be placed
+    static size_type probe(const std::vector<slot, sa_t>& slots,
+        key_type key, std::size_t hash) noexcept
+    {
+        const auto mask = slots.size() - 1;
+        auto s = hash & mask;
+        for (; slots[s].first != npos; s = (s + 1) & mask) {
+            const auto& t = slots[s];
+            if ((t.hash == hash) && (key_type(t.key) == key)) {
+                break;
+            }
+        }
+        return s;
+    }
+
+    // Indexes v as the value of the record next to the last indexed one;
+    // has no effects if an exception is thrown
+    void add(const value_t& v)
+    {
+        const auto i = next_.size();
+        if ((key_count_ + 1) * 2 > slots_.size()) {
+            grow();                                             // throw
+        }
+        const auto hash = std::hash<value_t>()(v);
+        auto& t = slots_[probe(slots_, key_type(v), hash)];
+        next_.push_back(npos);  // no reallocation thanks to reserve
+        if (t.first == npos) {
+            t.key = v;
+            t.hash = hash;
+            t.first = i;
+            ++key_count_;
+        } else {
+            next_[t.last] = i;
+        }
+        t.last = i;
+        ++value_count_;
+    }
+
+    void grow()
+    {
+        const auto n = slots_.empty() ? min_slot_count : slots_.size() * 2;
+        std::vector<slot, sa_t> slots(n, slot{ value_t(), 0, npos, npos },
+            slots_.get_allocator());                            // throw
+        for (const auto& t : slots_) {
+            if (t.first != npos) {
+                slots[probe(slots, key_type(t.key), t.hash)] = t;
+            }
+        }
+        slots_.swap(slots);
+    }
+};
+
+template <class Content, class Allocator>
+void swap(stored_table_index<Content, Allocator>& left,
+          stored_table_index<Content, Allocator>& right) noexcept
+{
+    left.swap(right);
+}
+
+template <class Content, class Allocator>
+[[nodiscard]] stored_table_index<Content, Allocator> make_stored_table_index(
+    basic_stored_table<Content, Allocator>& table, std::size_t column)
+{
+    return stored_table_index<Content, Allocator>(table, column);
+}
+
+}
+
+#endif
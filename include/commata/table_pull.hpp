@@ -6,6 +6,7 @@
 #ifndef COMMATA_GUARD_43DAA7B6_A9E7_4410_9210_CAADC6EA9D6F
 #define COMMATA_GUARD_43DAA7B6_A9E7_4410_9210_CAADC6EA9D6F
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
@@ -163,12 +164,15 @@ private:
     state_queue_type sq_;
     data_queue_type dq_;
     std::size_t yield_location_;
+    // Minimum number of events to be queued before the parser yields in the
+    // middle of a buffer
+    std::size_t batch_size_;
     bool collects_data_;
 
 public:
     handler(std::allocator_arg_t, const Allocator& alloc) :
         sq_(state_queue_a_t(alloc)), dq_(data_queue_a_t(alloc)),
-        yield_location_(0), collects_data_(true)
+        yield_location_(0), batch_size_(1), collects_data_(true)
     {}
 
     handler(const handler& other) = delete;
@@ -207,6 +211,17 @@ public:
         return *this;
     }
 
+    std::size_t get_batch_size() const noexcept
+    {
+        return batch_size_;
+    }
+
+    handler& set_batch_size(std::size_t n) noexcept
+    {
+        batch_size_ = std::max<std::size_t>(n, 1);
+        return *this;
+    }
+
     void start_buffer(
         [[maybe_unused]] char_type* buffer_begin,
         [[maybe_unused]] char_type* buffer_end)
@@ -313,12 +328,18 @@ public:
 
     bool yield(std::size_t location) noexcept
     {
-        if ((location != static_cast<std::size_t>(-1)) && sq_.empty()) {
-            return false;
-        } else {
-            yield_location_ = location;
-            return true;
+        if (location != static_cast<std::size_t>(-1)) {
+            // Location 1 is in the middle of a buffer, where the parser can
+            // go on to queue more events; at the end of a buffer, which is
+            // location 2, the parser must yield the events queued so far
+            // because their data will be released with the buffer
+            if (sq_.empty()
+             || ((location == 1) && (sq_.size() < batch_size_))) {
+                return false;
+            }
         }
+        yield_location_ = location;
+        return true;
     }
 
     std::size_t yield_location() const noexcept
@@ -534,6 +555,23 @@ public:
         return *this;
     }
 
+    std::size_t get_batch_size() const noexcept
+    {
+        return handler_ ? handler_->get_batch_size() : 1;
+    }
+
+    // Makes the parser queue at least n events, or all events until the end
+    // of the current buffer, each time it is resumed; the physical position
+    // and the parse point then run ahead of the event at the front of the
+    // queue, and set_discarding_data affects only events queued after it
+    primitive_table_pull& set_batch_size(std::size_t n) noexcept
+    {
+        if (handler_) {
+            handler_->set_batch_size(n);
+        }
+        return *this;
+    }
+
     primitive_table_pull_state state() const noexcept
     {
         assert(sq_->size() > i_sq_);
@@ -843,6 +881,17 @@ public:
         return *this;
     }
 
+    std::size_t get_batch_size() const noexcept
+    {
+        return p_.get_batch_size();
+    }
+
+    table_pull& set_batch_size(std::size_t n) noexcept
+    {
+        p_.set_batch_size(n);
+        return *this;
+    }
+
     table_pull_state state() const noexcept
     {
         return state_;
@@ -900,7 +949,7 @@ public:
             return *this;
         }
 
-        p_.set_discarding_data(true);
+        discard_data();
         temporarily_discard d(&p_);
         try {
             for (;;) {
@@ -939,6 +988,16 @@ public:
     }
 
 private:
+    void discard_data() noexcept
+    {
+        // Events queued while data are discarded lack their data even after
+        // discarding is turned off, which may happen before all of them are
+        // consumed unless they are queued one by one
+        if (p_.get_batch_size() == 1) {
+            p_.set_discarding_data(true);
+        }
+    }
+
     void next_field()
     {
         assert(*this);
@@ -1020,7 +1079,7 @@ public:
             j_ = 0;
         }
 
-        p_.set_discarding_data(true);
+        discard_data();
         temporarily_discard d(&p_);
         try {
             for (;;) {
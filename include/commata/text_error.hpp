@@ -23,6 +23,7 @@
 #include <type_traits>
 #include <utility>
 
+#include "detail/exceptions.hpp"
 #include "detail/formatted_output.hpp"
 
 namespace commata {
@@ -220,11 +221,15 @@ public:
     {
         // noexcept-ness counts; we must throw exceptions only when the sentry
         // exists and beholds us
+#ifdef COMMATA_EXCEPTIONS_ENABLED
         try {
+#endif
             facet_ = &std::use_facet<std::ctype<Ch>>(os.getloc());
+#ifdef COMMATA_EXCEPTIONS_ENABLED
         } catch (...) {
             ex_ = std::current_exception();
         }
+#endif
     }
 
     bool operator()(std::basic_streambuf<Ch, Tr>* sb,
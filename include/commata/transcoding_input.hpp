@@ -0,0 +1,591 @@
+/**
+ * These codes are licensed under the Unlicense.
+ * http://unlicense.org
+ */
+
+#ifndef COMMATA_GUARD_FDAE3139_ED81_4DDB_9DDF_7B42B9D7FD80
+#define COMMATA_GUARD_FDAE3139_ED81_4DDB_9DDF_7B42B9D7FD80
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "encoding_error.hpp"
+#include "detail/char_search.hpp"
+#include "detail/cp932_table.hpp"
+#include "detail/exceptions.hpp"
+#include "detail/typing_aid.hpp"
+
+namespace commata {
+
+enum class invalid_sequence : std::uint_fast8_t
+{
+    replace, skip, error
+};
+
+namespace detail::transcode {
+
+constexpr char32_t invalid_code_point = 0xFFFFFFFF;
+
+struct decode_result
+{
+    // invalid_code_point if the sequence is invalid
+    char32_t code_point;
+    // Length in bytes of the (valid or invalid) sequence, or 0 if the
+    // sequence is incomplete
+    std::size_t length;
+};
+
+// Writes code_point to out in UTF-8, UTF-16 or UTF-32 according to the size
+// of Ch and returns the number of units written
+template <class Ch>
+std::size_t encode(char32_t code_point, Ch* out) noexcept
+{
+    if constexpr (sizeof(Ch) == 1) {
+        if (code_point < 0x80) {
+            out[0] = static_cast<Ch>(code_point);
+            return 1;
+        } else if (code_point < 0x800) {
+            out[0] = static_cast<Ch>(0xC0 | (code_point >> 6));
+            out[1] = static_cast<Ch>(0x80 | (code_point & 0x3F));
+            return 2;
+        } else if (code_point < 0x10000) {
+            out[0] = static_cast<Ch>(0xE0 | (code_point >> 12));
+            out[1] = static_cast<Ch>(0x80 | ((code_point >> 6) & 0x3F));
+            out[2] = static_cast<Ch>(0x80 | (code_point & 0x3F));
+            return 3;
+        } else {
+            out[0] = static_cast<Ch>(0xF0 | (code_point >> 18));
+            out[1] = static_cast<Ch>(0x80 | ((code_point >> 12) & 0x3F));
+            out[2] = static_cast<Ch>(0x80 | ((code_point >> 6) & 0x3F));
+            out[3] = static_cast<Ch>(0x80 | (code_point & 0x3F));
+            return 4;
+        }
+    } else if constexpr (sizeof(Ch) == 2) {
+        if (code_point < 0x10000) {
+            out[0] = static_cast<Ch>(code_point);
+            return 1;
+        } else {
+            const auto c = code_point - 0x10000;
+            out[0] = static_cast<Ch>(0xD800 | (c >> 10));
+            out[1] = static_cast<Ch>(0xDC00 | (c & 0x3FF));
+            return 2;
+        }
+    } else {
+        out[0] = static_cast<Ch>(code_point);
+        return 1;
+    }
+}
+
+// Converts the longest prefix of [first, last) which consists of ASCII chars,
+// or of any bytes if AsciiOnly is false, to units of Ch whose values are the
+// same as the bytes, as many as out_last - out permits, and advances first
+// and out past them
+template <bool AsciiOnly, class Ch>
+void widen_bytes(const unsigned char*& first, const unsigned char* last,
+    Ch*& out, Ch* out_last) noexcept
+{
+    auto n = std::min<std::ptrdiff_t>(last - first, out_last - out);
+#ifdef COMMATA_SIMD_SSE2
+    if constexpr (simd::is_vectorizable_v<Ch>) {
+        const __m128i zero = _mm_setzero_si128();
+        while (n >= 16) {
+            const __m128i v =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            if (AsciiOnly && (_mm_movemask_epi8(v) != 0)) {
+                break;
+            }
+            if constexpr (sizeof(Ch) == 1) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out), v);
+            } else {
+                const __m128i lo = _mm_unpacklo_epi8(v, zero);
+                const __m128i hi = _mm_unpackhi_epi8(v, zero);
+                if constexpr (sizeof(Ch) == 2) {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), lo);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), hi);
+                } else {
+                    const auto p = reinterpret_cast<__m128i*>(out);
+                    _mm_storeu_si128(p,     _mm_unpacklo_epi16(lo, zero));
+                    _mm_storeu_si128(p + 1, _mm_unpackhi_epi16(lo, zero));
+                    _mm_storeu_si128(p + 2, _mm_unpacklo_epi16(hi, zero));
+                    _mm_storeu_si128(p + 3, _mm_unpackhi_epi16(hi, zero));
+                }
+            }
+            first += 16;
+            out += 16;
+            n -= 16;
+        }
+    }
+#endif
+    for (; (n > 0) && (!AsciiOnly || (*first < 0x80)); --n) {
+        *out = static_cast<Ch>(*first);
+        ++first;
+        ++out;
+    }
+}
+
+template <bool BigEndian>
+char16_t load_unit(const unsigned char* p) noexcept
+{
+    return BigEndian ? static_cast<char16_t>((p[0] << 8) | p[1]) :
+                       static_cast<char16_t>((p[1] << 8) | p[0]);
+}
+
+// Converts the longest prefix of [first, last) which consists of UTF-16 units
+// other than surrogates to units of Ch, which shall be wider than one byte,
+// as many as out_last - out permits, and advances first and out past them
+template <bool BigEndian, class Ch>
+void widen_bmp(const unsigned char*& first, const unsigned char* last,
+    Ch*& out, Ch* out_last) noexcept
+{
+    static_assert(sizeof(Ch) > 1);
+    auto n = std::min<std::ptrdiff_t>((last - first) / 2, out_last - out);
+#ifdef COMMATA_SIMD_SSE2
+    if constexpr (simd::is_vectorizable_v<Ch>) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i surrogate_mask = _mm_set1_epi16(
+            static_cast<short>(0xF800));
+        const __m128i surrogate = _mm_set1_epi16(static_cast<short>(0xD800));
+        while (n >= 8) {
+            __m128i v =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            if constexpr (BigEndian) {
+                v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+            }
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(
+                    _mm_and_si128(v, surrogate_mask), surrogate)) != 0) {
+                break;
+            }
+            if constexpr (sizeof(Ch) == 2) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out), v);
+            } else {
+                const auto p = reinterpret_cast<__m128i*>(out);
+                _mm_storeu_si128(p,     _mm_unpacklo_epi16(v, zero));
+                _mm_storeu_si128(p + 1, _mm_unpackhi_epi16(v, zero));
+            }
+            first += 16;
+            out += 8;
+            n -= 8;
+        }
+    }
+#endif
+    for (; n > 0; --n) {
+        const auto u = load_unit<BigEndian>(first);
+        if ((u & 0xF800) == 0xD800) {
+            break;
+        }
+        *out = static_cast<Ch>(u);
+        first += 2;
+        ++out;
+    }
+}
+
+template <bool BigEndian>
+struct utf16_encoding
+{
+    static constexpr const char* name = BigEndian ? "UTF-16BE" : "UTF-16LE";
+
+    static decode_result decode(
+        const unsigned char* first, const unsigned char* last) noexcept
+    {
+        if (last - first < 2) {
+            return { invalid_code_point, 0 };
+        }
+        const auto u = load_unit<BigEndian>(first);
+        if ((u & 0xF800) != 0xD800) {
+            return { u, 2 };
+        } else if (u >= 0xDC00) {
+            return { invalid_code_point, 2 };   // lone low surrogate
+        } else if (last - first < 4) {
+            return { invalid_code_point, 0 };
+        }
+        const auto v = load_unit<BigEndian>(first + 2);
+        if ((v & 0xFC00) != 0xDC00) {
+            return { invalid_code_point, 2 };   // lone high surrogate
+        }
+        return { 0x10000 + (static_cast<char32_t>(u - 0xD800) << 10)
+                         + (v - 0xDC00), 4 };
+    }
+
+    template <class Ch>
+    static void convert_fast(const unsigned char*& first,
+        const unsigned char* last, Ch*& out, Ch* out_last) noexcept
+    {
+        if constexpr (sizeof(Ch) > 1) {
+            widen_bmp<BigEndian>(first, last, out, out_last);
+        }
+    }
+};
+
+} // end detail::transcode
+
+// Encodings of the bytes read by transcoding_input
+
+struct utf8_encoding
+{
+    static constexpr const char* name = "UTF-8";
+
+    static detail::transcode::decode_result decode(
+        const unsigned char* first, const unsigned char* last) noexcept
+    {
+        using detail::transcode::invalid_code_point;
+        const auto b0 = first[0];
+        if (b0 < 0x80) {
+            return { b0, 1 };
+        }
+        std::size_t length;
+        char32_t c;
+        unsigned char lower = 0x80;
+        unsigned char upper = 0xBF;
+        if ((b0 >= 0xC2) && (b0 <= 0xDF)) {
+            length = 2;
+            c = b0 & 0x1F;
+        } else if ((b0 >= 0xE0) && (b0 <= 0xEF)) {
+            length = 3;
+            c = b0 & 0x0F;
+            if (b0 == 0xE0) {
+                lower = 0xA0;           // overlong
+            } else if (b0 == 0xED) {
+                upper = 0x9F;           // surrogate
+            }
+        } else if ((b0 >= 0xF0) && (b0 <= 0xF4)) {
+            length = 4;
+            c = b0 & 0x07;
+            if (b0 == 0xF0) {
+                lower = 0x90;           // overlong
+            } else if (b0 == 0xF4) {
+                upper = 0x8F;           // beyond U+10FFFF
+            }
+        } else {
+            return { invalid_code_point, 1 };
+        }
+        // An invalid sequence is as long as its longest valid prefix
+        for (std::size_t i = 1; i < length; ++i) {
+            if (first + i == last) {
+                return { invalid_code_point, 0 };
+            }
+            const auto b = first[i];
+            if ((b < lower) || (b > upper)) {
+                return { invalid_code_point, i };
+            }
+            c = (c << 6) | (b & 0x3F);
+            lower = 0x80;
+            upper = 0xBF;
+        }
+        return { c, length };
+    }
+
+    template <class Ch>
+    static void convert_fast(const unsigned char*& first,
+        const unsigned char* last, Ch*& out, Ch* out_last) noexcept
+    {
+        detail::transcode::widen_bytes<true>(first, last, out, out_last);
+    }
+};
+
+// ISO/IEC 8859-1, whose bytes are the code points themselves
+struct latin1_encoding
+{
+    static constexpr const char* name = "ISO-8859-1";
+
+    static detail::transcode::decode_result decode(
+        const unsigned char* first, const unsigned char* /*last*/) noexcept
+    {
+        return { first[0], 1 };
+    }
+
+    template <class Ch>
+    static void convert_fast(const unsigned char*& first,
+        const unsigned char* last, Ch*& out, Ch* out_last) noexcept
+    {
+        // Non-ASCII chars need two units in UTF-8
+        detail::transcode::widen_bytes<sizeof(Ch) == 1>(
+            first, last, out, out_last);
+    }
+};
+
+// CP932 (Windows-31J), Microsoft's variant of Shift_JIS
+struct cp932_encoding
+{
+    static constexpr const char* name = "CP932";
+
+    static detail::transcode::decode_result decode(
+        const unsigned char* first, const unsigned char* last) noexcept
+    {
+        using detail::transcode::invalid_code_point;
+        const auto b0 = first[0];
+        if (b0 < 0x80) {
+            return { b0, 1 };
+        } else if ((b0 >= 0xA1) && (b0 <= 0xDF)) {
+            // Halfwidth katakana
+            return { static_cast<char32_t>(0xFF61 + (b0 - 0xA1)), 1 };
+        } else if (b0 == 0x80) {
+            return { 0x80, 1 };
+        } else if (b0 == 0xA0) {
+            return { 0xF8F0, 1 };
+        } else if (b0 >= 0xFD) {
+            return { static_cast<char32_t>(0xF8F1 + (b0 - 0xFD)), 1 };
+        } else if (last - first < 2) {
+            return { invalid_code_point, 0 };
+        }
+        const auto b1 = first[1];
+        if ((b1 < 0x40) || (b1 == 0x7F) || (b1 > 0xFC)) {
+            // The second byte is not a trail byte, so it is decoded on its
+            // own; this keeps an ASCII char such as a quotation mark or a
+            // line terminator after a broken lead byte
+            return { invalid_code_point, 1 };
+        }
+        const std::size_t lead = (b0 < 0xA0) ? (b0 - 0x81) : (b0 - 0xC1);
+        const std::size_t trail = (b1 < 0x7F) ? (b1 - 0x40) : (b1 - 0x41);
+        const auto c =
+            detail::transcode::cp932_double_byte[lead * 188 + trail];
+        if (c == 0) {
+            // Like the WHATWG Shift_JIS decoder, an ASCII trail byte of an
+            // unmapped pair is decoded on its own
+            return { invalid_code_point, (b1 < 0x80) ? 1U : 2U };
+        }
+        return { c, 2 };
+    }
+
+    template <class Ch>
+    static void convert_fast(const unsigned char*& first,
+        const unsigned char* last, Ch*& out, Ch* out_last) noexcept
+    {
+        detail::transcode::widen_bytes<true>(first, last, out, out_last);
+    }
+};
+
+using utf16le_encoding = detail::transcode::utf16_encoding<false>;
+using utf16be_encoding = detail::transcode::utf16_encoding<true>;
+
+// Reads bytes in Encoding from Input, whose char_type shall be char, and
+// converts them to Ch in UTF-8, UTF-16 or UTF-32 according to the size of Ch
+template <class Input, class Encoding, class Ch = wchar_t,
+    class Tr = std::char_traits<Ch>>
+class transcoding_input
+{
+    static_assert(std::is_same_v<typename Input::char_type, char>);
+    static_assert(std::is_same_v<Ch, typename Tr::char_type>);
+
+public:
+    using base_type = Input;
+    using char_type = Ch;
+    using traits_type = Tr;
+    using size_type = std::size_t;
+
+    static constexpr std::size_t default_buffer_size = 1U << 16;
+
+private:
+    // Longest sequences are four bytes, and at most four units are written
+    // for a code point
+    static constexpr std::size_t max_sequence = 4;
+
+    Input in_;
+    std::unique_ptr<unsigned char[]> buffer_;
+    std::size_t buffer_size_;
+    // Bytes which have been read but have not been decoded yet
+    const unsigned char* first_;
+    const unsigned char* last_;
+    bool in_eof_;
+    // Offset in bytes of first_ from the start of the text
+    std::size_t offset_;
+
+    invalid_sequence on_invalid_;
+    char32_t replacement_;
+
+    // Units which have been decoded but have not been handed yet
+    Ch pending_[max_sequence];
+    std::size_t pending_first_;
+    std::size_t pending_last_;
+
+public:
+    transcoding_input() noexcept(
+        std::is_nothrow_default_constructible_v<Input>) :
+        buffer_size_(0), first_(nullptr), last_(nullptr), in_eof_(true),
+        offset_(0), on_invalid_(invalid_sequence::replace),
+        replacement_(0xFFFD), pending_first_(0), pending_last_(0)
+    {}
+
+    explicit transcoding_input(Input in,
+        invalid_sequence on_invalid = invalid_sequence::replace,
+        char32_t replacement = 0xFFFD, std::size_t buffer_size = 0) :
+        in_(std::move(in)),
+        buffer_size_(std::max((buffer_size == 0) ?
+            default_buffer_size : buffer_size, max_sequence)),
+        first_(nullptr), last_(nullptr), in_eof_(false), offset_(0),
+        on_invalid_(on_invalid), replacement_(replacement),
+        pending_first_(0), pending_last_(0)
+    {
+        buffer_.reset(new unsigned char[buffer_size_]);
+        first_ = buffer_.get();
+        last_ = first_;
+    }
+
+    transcoding_input(transcoding_input&& other) noexcept(
+        std::is_nothrow_move_constructible_v<Input>) :
+        in_(std::move(other.in_)), buffer_(std::move(other.buffer_)),
+        buffer_size_(std::exchange(other.buffer_size_, 0)),
+        first_(std::exchange(other.first_, nullptr)),
+        last_(std::exchange(other.last_, nullptr)),
+        in_eof_(std::exchange(other.in_eof_, true)),
+        offset_(other.offset_), on_invalid_(other.on_invalid_),
+        replacement_(other.replacement_),
+        pending_first_(std::exchange(other.pending_first_, 0)),
+        pending_last_(std::exchange(other.pending_last_, 0))
+    {
+        std::copy(other.pending_, other.pending_ + max_sequence, pending_);
+    }
+
+    ~transcoding_input() = default;
+
+    transcoding_input& operator=(transcoding_input&& other) noexcept(
+        std::is_nothrow_move_constructible_v<Input>
+     && std::is_nothrow_swappable_v<Input>)
+    {
+        transcoding_input(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    const Input& base() const noexcept
+    {
+        return in_;
+    }
+
+    Input& base() noexcept
+    {
+        return in_;
+    }
+
+    size_type operator()(Ch* out, size_type n)
+    {
+        Ch* p = out;
+        Ch* const out_last = out + n;
+        while (p < out_last) {
+            if (pending_first_ < pending_last_) {
+                const auto m = std::min<std::size_t>(
+                    pending_last_ - pending_first_, out_last - p);
+                Tr::copy(p, pending_ + pending_first_, m);
+                p += m;
+                pending_first_ += m;
+                continue;
+            }
+
+            const auto first = first_;
+            Encoding::convert_fast(first_, last_, p, out_last);
+            offset_ += first_ - first;
+            if (p == out_last) {
+                break;
+            }
+
+            auto r = (first_ < last_) ?
+                Encoding::decode(first_, last_) :
+                detail::transcode::decode_result{
+                    detail::transcode::invalid_code_point, 0 };
+            if (r.length == 0) {
+                if (fill()) {
+                    continue;
+                } else if (first_ == last_) {
+                    break;                                      // eof
+                }
+                r.length = last_ - first_;  // incomplete at the end
+            }
+            if (r.code_point == detail::transcode::invalid_code_point) {
+                switch (on_invalid_) {
+                case invalid_sequence::replace:
+                    r.code_point = replacement_;
+                    break;
+                case invalid_sequence::skip:
+                    first_ += r.length;
+                    offset_ += r.length;
+                    continue;
+                default:
+                    throw_invalid();
+                }
+            }
+            first_ += r.length;
+            offset_ += r.length;
+            pending_first_ = 0;
+            pending_last_ = detail::transcode::encode(r.code_point, pending_);
+        }
+        return p - out;
+    }
+
+    void swap(transcoding_input& other)
+        noexcept(std::is_nothrow_swappable_v<Input>)
+    {
+        using std::swap;
+        swap(in_, other.in_);
+        swap(buffer_, other.buffer_);
+        swap(buffer_size_, other.buffer_size_);
+        swap(first_, other.first_);
+        swap(last_, other.last_);
+        swap(in_eof_, other.in_eof_);
+        swap(offset_, other.offset_);
+        swap(on_invalid_, other.on_invalid_);
+        swap(replacement_, other.replacement_);
+        swap(pending_, other.pending_);
+        swap(pending_first_, other.pending_first_);
+        swap(pending_last_, other.pending_last_);
+    }
+
+private:
+    // Moves the bytes which have not been decoded to the front of the buffer
+    // and reads more bytes after them; returns false if no bytes are read
+    bool fill()
+    {
+        if (in_eof_) {
+            return false;
+        }
+        const auto rest = static_cast<std::size_t>(last_ - first_);
+        std::memmove(buffer_.get(), first_, rest);
+        first_ = buffer_.get();
+        last_ = first_ + rest;
+
+        using input_size_t = typename Input::size_type;
+        const auto n = static_cast<input_size_t>(std::min<std::common_type_t<
+                std::size_t, input_size_t>>(buffer_size_ - rest,
+                    std::numeric_limits<input_size_t>::max()));
+        std::size_t length;
+        do {
+            length = static_cast<std::size_t>(in_(
+                reinterpret_cast<char*>(buffer_.get() + rest), n));
+            if constexpr (detail::reports_eof_v<Input>) {
+                in_eof_ = in_.eof();
+            } else {
+                in_eof_ = (length < n);
+            }
+        } while ((length == 0) && !in_eof_);
+        last_ += length;
+        return length > 0;
+    }
+
+    [[noreturn]] void throw_invalid() const
+    {
+#ifdef COMMATA_EXCEPTIONS_ENABLED
+        throw encoding_error(std::string("Invalid ") + Encoding::name
+            + " sequence at byte offset " + std::to_string(offset_));
+#else
+        std::abort();
+#endif
+    }
+};
+
+template <class Input, class Encoding, class Ch, class Tr>
+auto swap(transcoding_input<Input, Encoding, Ch, Tr>& left,
+          transcoding_input<Input, Encoding, Ch, Tr>& right)
+    noexcept(noexcept(left.swap(right)))
+ -> std::enable_if_t<std::is_swappable_v<Input>>
+{
+    left.swap(right);
+}
+
+}
+
+#endif
@@ -3,10 +3,13 @@
  * http://unlicense.org
  */
 
+#include <cstddef>
 #include <ios>
 #include <memory>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -16,6 +19,7 @@
 #include <commata/char_input.hpp>
 
 #include "BaseTest.hpp"
+#include "piecewise_streambuf.hpp"
 
 using namespace std::string_literals;
 using namespace std::string_view_literals;
@@ -26,6 +30,8 @@ using namespace commata::test;
 static_assert(std::is_trivially_copyable_v<streambuf_input<char>>);
 static_assert(std::is_trivially_copyable_v<istream_input<char>>);
 static_assert(std::is_trivially_copyable_v<string_input<wchar_t>>);
+static_assert(std::is_trivially_copyable_v<partial_read_input<std::istream>>);
+static_assert(std::is_trivially_copyable_v<direct_read_input<std::istream>>);
 
 struct TestStreambufInput : BaseTest
 {};
@@ -293,6 +299,216 @@ TEST_F(TestOwnedIStreamInput, ThrowAsStream)
                                                     // to failbit|eofbit
 }
 
+struct TestPartialReadInput : BaseTest
+{};
+
+TEST_F(TestPartialReadInput, Streambuf)
+{
+    piecewise_streambuf<char> s({ "123", "", "4567" });
+    auto in = make_char_input(partial_read, s);
+    static_assert(std::is_same_v<decltype(in),
+                                 partial_read_input<std::streambuf>>);
+    char b[5];
+
+    ASSERT_EQ(2U, in(b, 2));    // reads 12
+    ASSERT_FALSE(in.eof());
+    ASSERT_EQ(1U, in(b, 4));    // reads 3 without waiting for 4567
+    ASSERT_FALSE(in.eof());
+    ASSERT_EQ(4U, in(b, 4));    // reads 4567
+    b[4] = '\0';
+    ASSERT_STREQ("4567", b);
+    ASSERT_FALSE(in.eof());
+    ASSERT_EQ(0U, in(b, 4));
+    ASSERT_TRUE(in.eof());
+}
+
+TEST_F(TestPartialReadInput, IStream)
+{
+    piecewise_streambuf<wchar_t> s({ L"123", L"4567" });
+    std::wistream is(&s);
+    auto in = make_char_input(partial_read, is);
+    static_assert(std::is_same_v<decltype(in),
+                                 partial_read_input<std::wistream>>);
+    wchar_t b[5];
+
+    ASSERT_EQ(3U, in(b, 4));    // reads 123 without waiting for 4567
+    ASSERT_FALSE(in.eof());
+    ASSERT_EQ(4U, in(b, 4));    // reads 4567
+    b[4] = L'\0';
+    ASSERT_STREQ(L"4567", b);
+    ASSERT_EQ(0U, in(b, 4));
+    ASSERT_TRUE(in.eof());
+}
+
+TEST_F(TestPartialReadInput, DefaultConstructed)
+{
+    partial_read_input<std::streambuf> in;
+    char b[4];
+    ASSERT_TRUE(in.eof());
+    ASSERT_EQ(0U, in(b, 4));
+}
+
+namespace {
+
+// Serves a string one char at a time without using its get area
+class getless_streambuf : public std::streambuf
+{
+    std::string s_;
+    std::size_t i_;
+
+public:
+    explicit getless_streambuf(std::string s) :
+        s_(std::move(s)), i_(0)
+    {}
+
+protected:
+    int_type underflow() override
+    {
+        return (i_ < s_.size()) ?
+            traits_type::to_int_type(s_[i_]) : traits_type::eof();
+    }
+
+    int_type uflow() override
+    {
+        return (i_ < s_.size()) ?
+            traits_type::to_int_type(s_[i_++]) : traits_type::eof();
+    }
+};
+
+// Throws when it is read from
+class throwing_streambuf : public std::streambuf
+{
+protected:
+    int_type underflow() override
+    {
+        throw std::runtime_error("underflow");
+    }
+};
+
+} // end unnamed
+
+struct TestDirectReadInput : BaseTest
+{};
+
+TEST_F(TestDirectReadInput, Streambuf)
+{
+    piecewise_streambuf<char> s({ "123", "", "4567" });
+    auto in = make_char_input(direct_read, s);
+    static_assert(std::is_same_v<decltype(in),
+                                 direct_read_input<std::streambuf>>);
+
+    auto r = in(2);             // reads 12
+    ASSERT_EQ("12"sv, std::string_view(r.first, r.second));
+    ASSERT_FALSE(in.eof());
+    r = in(10);                 // reads 3 without waiting for 4567
+    ASSERT_EQ("3"sv, std::string_view(r.first, r.second));
+    r = in(10);                 // reads 4567
+    ASSERT_EQ("4567"sv, std::string_view(r.first, r.second));
+    ASSERT_FALSE(in.eof());
+    r = in(10);
+    ASSERT_EQ(0U, r.second);
+    ASSERT_TRUE(in.eof());
+}
+
+TEST_F(TestDirectReadInput, NoCopy)
+{
+    std::stringbuf s("1234567");
+    direct_read_input<std::streambuf> in(s);
+    const auto r1 = in(3);
+    const auto r2 = in(10);
+    ASSERT_EQ("123"sv, std::string_view(r1.first, r1.second));
+    ASSERT_EQ("4567"sv, std::string_view(r2.first, r2.second));
+    ASSERT_EQ(r1.first + 3, r2.first);
+}
+
+TEST_F(TestDirectReadInput, GetAreaUnused)
+{
+    getless_streambuf s("12");
+    direct_read_input<std::streambuf> in(s);
+    auto r = in(10);
+    ASSERT_EQ("1"sv, std::string_view(r.first, r.second));
+    r = in(10);
+    ASSERT_EQ("2"sv, std::string_view(r.first, r.second));
+    r = in(10);
+    ASSERT_EQ(0U, r.second);
+    ASSERT_TRUE(in.eof());
+}
+
+TEST_F(TestDirectReadInput, IStream)
+{
+    piecewise_streambuf<wchar_t> s({ L"123", L"4567" });
+    std::wistream is(&s);
+    auto in = make_char_input(direct_read, is);
+    static_assert(std::is_same_v<decltype(in),
+                                 direct_read_input<std::wistream>>);
+
+    auto r = in(10);
+    ASSERT_EQ(L"123"sv, std::wstring_view(r.first, r.second));
+    r = in(10);
+    ASSERT_EQ(L"4567"sv, std::wstring_view(r.first, r.second));
+    ASSERT_TRUE(is.good());
+    r = in(10);
+    ASSERT_EQ(0U, r.second);
+    ASSERT_TRUE(in.eof());
+    ASSERT_TRUE(is.eof());
+    ASSERT_FALSE(is.fail());
+}
+
+TEST_F(TestDirectReadInput, IStreamFailed)
+{
+    // A stream which has failed is not taken for one which has ended
+    std::stringbuf s("123");
+    std::istream is(&s);
+    is.setstate(std::ios_base::failbit);
+    direct_read_input<std::istream> in(is);
+    ASSERT_THROW(in(10), std::ios_base::failure);
+    ASSERT_TRUE(is.bad());
+    ASSERT_TRUE(in.eof());
+
+    // A stream which has ended before is taken for one which has ended
+    std::stringbuf s2("");
+    std::istream is2(&s2);
+    is2.setstate(std::ios_base::eofbit);
+    direct_read_input<std::istream> in2(is2);
+    ASSERT_EQ(0U, in2(10).second);
+    ASSERT_TRUE(in2.eof());
+    ASSERT_FALSE(is2.bad());
+}
+
+TEST_F(TestDirectReadInput, IStreamThrowing)
+{
+    // An exception from the streambuf makes the stream bad and propagates
+    throwing_streambuf s;
+    std::istream is(&s);
+    direct_read_input<std::istream> in(is);
+    ASSERT_THROW(in(10), std::runtime_error);
+    ASSERT_TRUE(is.bad());
+    ASSERT_TRUE(in.eof());
+}
+
+TEST_F(TestDirectReadInput, Copy)
+{
+    std::stringbuf s("1234567");
+    direct_read_input<std::streambuf> in(s);
+    char b[5];
+
+    ASSERT_EQ(4U, in(b, 4));    // reads 1234
+    ASSERT_FALSE(in.eof());
+    ASSERT_EQ(3U, in(b, 4));    // reads 567
+    b[3] = '\0';
+    ASSERT_STREQ("567", b);
+    ASSERT_TRUE(in.eof());
+}
+
+TEST_F(TestDirectReadInput, DefaultConstructed)
+{
+    direct_read_input<std::streambuf> in;
+    char b[4];
+    ASSERT_TRUE(in.eof());
+    ASSERT_EQ(0U, in(b, 4));
+    ASSERT_EQ(0U, in(4).second);
+}
+
 struct TestStringInput : BaseTest
 {};
 
@@ -0,0 +1,205 @@
+/**
+ * These codes are licensed under the Unlicense.
+ * http://unlicense.org
+ */
+
+#ifdef _MSC_VER
+#pragma warning(disable:4996)
+#endif
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include <commata/columnar_stored_table.hpp>
+#include <commata/parse_csv.hpp>
+
+#include "BaseTest.hpp"
+
+using namespace commata;
+using namespace commata::test;
+
+static_assert(std::is_nothrow_move_constructible_v<columnar_stored_table>);
+static_assert(std::is_nothrow_swappable_v<columnar_stored_table>);
+static_assert(std::is_same_v<columnar_stored_table::value_type,
+                             cstored_value>);
+
+struct TestColumnarStoredTable : BaseTestWithParam<std::size_t>
+{};
+
+TEST_P(TestColumnarStoredTable, Basics)
+{
+    const char* s = "\r\n"
+                    R"("key_a",key_b,value_a,value_b)" "\n"
+                    R"(ka1,"kb""01""",va1,)" "\n"
+                    R"(ka2,"","""va2""")" "\n"
+                    R"("k""a""1","kb""13""","vb)" "\n"
+                    R"(3",vb4,extra)";
+    columnar_stored_table table;
+    try {
+        parse_csv(s, make_stored_table_builder(table), GetParam());
+    } catch (const text_error& e) {
+        FAIL() << text_error_info(e);
+    }
+
+    ASSERT_EQ(4U, table.size());
+    ASSERT_EQ(5U, table.column_count());
+    for (std::size_t j = 0; j < table.column_count(); ++j) {
+        ASSERT_EQ(4U, table.column(j).size()) << j;
+    }
+
+    ASSERT_EQ("key_a",    table(0, 0));
+    ASSERT_EQ("ka1",      table(1, 0));
+    ASSERT_EQ("ka2",      table(2, 0));
+    ASSERT_EQ("k\"a\"1",  table(3, 0));
+    ASSERT_EQ("kb\"01\"", table(1, 1));
+    ASSERT_EQ("",         table(2, 1));
+    ASSERT_TRUE(table.has_value(2, 1));
+    ASSERT_EQ("\"va2\"",  table(2, 2));
+    ASSERT_EQ("vb\n3",    table(3, 2));
+    ASSERT_EQ("",         table(1, 3));
+    ASSERT_TRUE(table.has_value(1, 3));
+    ASSERT_EQ("",         table(2, 3));
+    ASSERT_FALSE(table.has_value(2, 3));
+    ASSERT_EQ("vb4",      table(3, 3));
+
+    // A column which appears late has no values for the preceding records
+    const auto& c = table.column(4);
+    ASSERT_FALSE(c.has_value(0));
+    ASSERT_FALSE(c.has_value(1));
+    ASSERT_FALSE(c.has_value(2));
+    ASSERT_TRUE(c.has_value(3));
+    ASSERT_EQ("extra", c[3]);
+    ASSERT_FALSE(table.has_value(0, 5));
+    ASSERT_EQ("", table(0, 5));
+
+    // Values are laid out contiguously in the arena with their terminators
+    const auto& k = table.column(0);
+    ASSERT_EQ(0U, k.offsets()[0]);
+    ASSERT_EQ(6U, k.offsets()[1]);
+    ASSERT_EQ(10U, k.offsets()[2]);
+    ASSERT_EQ(k.size_of_chars(), k.offsets()[k.size()]);
+    ASSERT_EQ(k.chars() + 6, k[1].c_str());
+    ASSERT_EQ(std::string("key_a\0ka1\0ka2\0k\"a\"1\0", 20),
+              std::string(k.chars(), k.size_of_chars()));
+}
+
+TEST_P(TestColumnarStoredTable, Wide)
+{
+    const wchar_t* s = L"A,B\n"
+                       L"C\n"
+                       L",D,\"E\nF\"";
+    wcolumnar_stored_table table;
+    try {
+        parse_csv(s, make_stored_table_builder(table), GetParam());
+    } catch (const text_error& e) {
+        FAIL() << text_error_info(e);
+    }
+
+    ASSERT_EQ(3U, table.size());
+    ASSERT_EQ(3U, table.column_count());
+    ASSERT_STREQ(L"A", table(0, 0).c_str());
+    ASSERT_STREQ(L"B", table(0, 1).c_str());
+    ASSERT_FALSE(table.has_value(0, 2));
+    ASSERT_STREQ(L"C", table(1, 0).c_str());
+    ASSERT_FALSE(table.has_value(1, 1));
+    ASSERT_FALSE(table.has_value(1, 2));
+    ASSERT_TRUE(table.has_value(2, 0));
+    ASSERT_STREQ(L"", table(2, 0).c_str());
+    ASSERT_STREQ(L"D", table(2, 1).c_str());
+    ASSERT_STREQ(L"E\nF", table(2, 2).c_str());
+}
+
+TEST_P(TestColumnarStoredTable, MaxRecordNum)
+{
+    const char* s = "a,b,c\n"
+                    "d,e,f,g\n";
+    columnar_stored_table table;
+    try {
+        parse_csv(s, make_stored_table_builder(table, 1U), GetParam());
+    } catch (const text_error& e) {
+        FAIL() << text_error_info(e);
+    }
+
+    ASSERT_EQ(1U, table.size());
+    ASSERT_EQ(3U, table.column_count());
+    ASSERT_EQ("a", table(0, 0));
+    ASSERT_EQ("c", table(0, 2));
+}
+
+TEST_P(TestColumnarStoredTable, EndRecordHandler)
+{
+    const char* s = "A,B,C\n"
+                    "I,J,K,L\n"
+                    "X,Y,Z\n"
+                    "P,Q,R\n";
+    columnar_stored_table table;
+    try {
+        parse_csv(s, make_stored_table_builder(table,
+            [](auto& t) {
+                const auto i = t.size() - 1;
+                if (t(i, 0) == "I") {
+                    t.pop_back();
+                } else if (t(i, 0) == "X") {
+                    return false;
+                }
+                return true;
+            }), GetParam());
+    } catch (const text_error& e) {
+        FAIL() << text_error_info(e);
+    }
+
+    ASSERT_EQ(2U, table.size());
+    ASSERT_EQ(4U, table.column_count());
+    ASSERT_EQ(2U, table.column(3).size());
+    ASSERT_EQ("A", table(0, 0));
+    ASSERT_EQ("C", table(0, 2));
+    ASSERT_FALSE(table.has_value(0, 3));
+    ASSERT_EQ("X", table(1, 0));
+    ASSERT_EQ("Z", table(1, 2));
+    ASSERT_FALSE(table.has_value(1, 3));
+}
+
+TEST_P(TestColumnarStoredTable, CopySwapClear)
+{
+    const char* s = "a,b\n"
+                    "c,d\n";
+    columnar_stored_table table1;
+    try {
+        parse_csv(s, make_stored_table_builder(table1), GetParam());
+    } catch (const text_error& e) {
+        FAIL() << text_error_info(e);
+    }
+
+    columnar_stored_table table2(table1);
+    ASSERT_EQ(2U, table2.size());
+    ASSERT_EQ("d", table2(1, 1));
+    ASSERT_NE(table1(1, 1).c_str(), table2(1, 1).c_str());
+
+    table1.clear();
+    ASSERT_TRUE(table1.empty());
+    ASSERT_EQ(0U, table1.column_count());
+
+    swap(table1, table2);
+    ASSERT_TRUE(table2.empty());
+    ASSERT_EQ(2U, table1.size());
+    ASSERT_EQ("c", table1(1, 0));
+
+    // Building onto a non-empty table appends records
+    try {
+        parse_csv("e,f,g", make_stored_table_builder(table1), GetParam());
+    } catch (const text_error& e) {
+        FAIL() << text_error_info(e);
+    }
+    table1.shrink_to_fit();
+    ASSERT_EQ(3U, table1.size());
+    ASSERT_EQ("a", table1(0, 0));
+    ASSERT_EQ("g", table1(2, 2));
+    ASSERT_FALSE(table1.has_value(1, 2));
+}
+
+INSTANTIATE_TEST_SUITE_P(,
+    TestColumnarStoredTable, testing::Values(2, 11, 1024));
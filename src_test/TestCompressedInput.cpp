@@ -0,0 +1,192 @@
+/**
+ * These codes are licensed under the Unlicense.
+ * http://unlicense.org
+ */
+
+#include <commata/compressed_input.hpp>
+
+#ifdef COMMATA_TEST_ZLIB
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <commata/char_input.hpp>
+#include <commata/parse_csv.hpp>
+#include <commata/prefetching_input.hpp>
+
+#include "BaseTest.hpp"
+#include "piecewise_streambuf.hpp"
+#include "test_collector.hpp"
+
+using namespace std::string_view_literals;
+
+using namespace commata;
+using namespace commata::test;
+
+namespace {
+
+std::string make_text()
+{
+    std::string s;
+    for (std::size_t i = 0; i < 5000; ++i) {
+        s += std::to_string(i);
+        s += (i % 7 == 6) ? "\n" : ",\"x\ny\",";
+    }
+    return s;
+}
+
+template <class Input>
+std::string read_all(Input& in, std::size_t n)
+{
+    std::string read;
+    std::vector<char> b(n);
+    for (;;) {
+        const auto length = in(b.data(), n);
+        read.append(b.data(), length);
+        if (length < n) {
+            break;
+        }
+    }
+    return read;
+}
+
+} // end unnamed
+
+#ifdef COMMATA_TEST_ZLIB
+
+#include <zlib.h>
+
+namespace {
+
+// Compresses s into a gzip member
+std::string gzip(std::string_view s)
+{
+    ::z_stream z = {};
+    if (::deflateInit2(&z, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+            MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return std::string();
+    }
+    std::string compressed(::deflateBound(&z, static_cast<::uLong>(s.size())),
+        '\0');
+    z.next_in = reinterpret_cast<::Bytef*>(const_cast<char*>(s.data()));
+    z.avail_in = static_cast<::uInt>(s.size());
+    z.next_out = reinterpret_cast<::Bytef*>(compressed.data());
+    z.avail_out = static_cast<::uInt>(compressed.size());
+    ::deflate(&z, Z_FINISH);
+    compressed.resize(z.total_out);
+    ::deflateEnd(&z);
+    return compressed;
+}
+
+} // end unnamed
+
+struct TestGzipInput : BaseTestWithParam<std::size_t>
+{};
+
+TEST_P(TestGzipInput, Read)
+{
+    const auto s = make_text();
+    const auto z = gzip(s);
+    ASSERT_LT(z.size(), s.size());
+    gzip_input in{string_input(z), GetParam()};
+    ASSERT_EQ(s, read_all(in, 100));
+    ASSERT_EQ(0U, in(nullptr, 0));
+}
+
+TEST_P(TestGzipInput, MultipleMembers)
+{
+    const auto z = gzip("ABC,") + gzip("DEF\nG") + gzip("HI\n");
+    gzip_input in{string_input(z), GetParam()};
+    ASSERT_EQ("ABC,DEF\nGHI\n", read_all(in, 5));
+}
+
+TEST_P(TestGzipInput, TrailingGarbage)
+{
+    // Bytes which do not begin a member, such as zeros padding the stream,
+    // are ignored
+    const std::string trailers[] = {
+        std::string(512, '\0'), "\x1f", "\x1f\x8c", "garbage\n"
+    };
+    for (const auto& trailer : trailers) {
+        const auto z = gzip("ABC,") + gzip("DEF\n") + trailer;
+        gzip_input in{string_input(z), GetParam()};
+        ASSERT_EQ("ABC,DEF\n", read_all(in, 5));
+        ASSERT_EQ(0U, in(nullptr, 0));
+    }
+}
+
+TEST_P(TestGzipInput, Empty)
+{
+    gzip_input in{string_input(""sv), GetParam()};
+    ASSERT_EQ("", read_all(in, 5));
+
+    const auto z = gzip("");
+    gzip_input in2{string_input(z), GetParam()};
+    ASSERT_EQ("", read_all(in2, 5));
+}
+
+TEST_P(TestGzipInput, Truncated)
+{
+    const auto s = make_text();
+    auto z = gzip(s);
+    z.resize(z.size() / 2);
+    gzip_input in{string_input(z), GetParam()};
+    ASSERT_THROW(read_all(in, 100), decompression_error);
+}
+
+TEST_P(TestGzipInput, Corrupted)
+{
+    gzip_input in{string_input("not compressed"sv), GetParam()};
+    ASSERT_THROW(read_all(in, 100), decompression_error);
+}
+
+TEST_P(TestGzipInput, ParseCsv)
+{
+    const auto s = make_text();
+    std::vector<std::vector<std::string>> expected;
+    ASSERT_TRUE(parse_csv(s, test_collector<char>(expected)));
+
+    const auto z = gzip(s);
+    std::vector<std::vector<std::string>> field_values;
+    ASSERT_TRUE(make_csv_source(gzip_input(string_input(z), GetParam()))
+        (test_collector<char>(field_values), 64)());
+    ASSERT_EQ(expected, field_values);
+}
+
+TEST_P(TestGzipInput, PartialRead)
+{
+    const auto z = gzip("A,B\nC\n");
+    std::vector<std::string> pieces;
+    for (std::size_t i = 0; i < z.size(); i += 3) {
+        pieces.push_back(z.substr(i, 3));
+        pieces.emplace_back();
+    }
+    piecewise_streambuf<char> sb(pieces);
+    gzip_input in(make_char_input(partial_read, sb), GetParam());
+    ASSERT_EQ("A,B\nC\n", read_all(in, 4));
+}
+
+TEST_P(TestGzipInput, Prefetching)
+{
+    const auto s = make_text();
+    std::vector<std::vector<std::string>> expected;
+    ASSERT_TRUE(parse_csv(s, test_collector<char>(expected)));
+
+    const auto z = gzip(s);
+    std::vector<std::vector<std::string>> field_values;
+    ASSERT_TRUE(make_csv_source(prefetching_input(
+            gzip_input(string_input(z), GetParam()), 1000))
+        (test_collector<char>(field_values))());
+    ASSERT_EQ(expected, field_values);
+}
+
+INSTANTIATE_TEST_SUITE_P(, TestGzipInput, testing::Values(0, 1, 7, 4096));
+
+#endif
+
+#endif
@@ -0,0 +1,164 @@
+/**
+ * These codes are licensed under the Unlicense.
+ * http://unlicense.org
+ */
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <commata/char_input.hpp>
+#include <commata/concat_input.hpp>
+#include <commata/parse_csv.hpp>
+
+#include "BaseTest.hpp"
+#include "piecewise_streambuf.hpp"
+#include "test_collector.hpp"
+
+using namespace std::string_view_literals;
+
+using namespace commata;
+using namespace commata::test;
+
+namespace {
+
+template <class Ch>
+std::vector<string_input<Ch>> make_inputs(
+    const std::vector<std::basic_string_view<Ch>>& texts)
+{
+    return std::vector<string_input<Ch>>(texts.cbegin(), texts.cend());
+}
+
+template <class Input>
+std::basic_string<typename Input::char_type> read_all(
+    Input& in, std::size_t n)
+{
+    std::basic_string<typename Input::char_type> read;
+    std::vector<typename Input::char_type> b(n);
+    for (;;) {
+        const auto length = in(b.data(), n);
+        read.append(b.data(), length);
+        if (length < n) {
+            break;
+        }
+    }
+    return read;
+}
+
+} // end unnamed
+
+struct TestConcatInput : BaseTestWithParam<std::size_t>
+{};
+
+TEST_P(TestConcatInput, Keep)
+{
+    concat_input in(make_inputs<char>(
+        { "a,b\n1,2\n"sv, ""sv, "a,b\r\n3,4"sv, "a,b\n5,6\r"sv }));
+    ASSERT_EQ("a,b\n1,2\na,b\r\n3,4\na,b\n5,6\r", read_all(in, GetParam()));
+    ASSERT_EQ(0U, in(nullptr, 0));
+}
+
+TEST_P(TestConcatInput, DropCsv)
+{
+    concat_input in(make_inputs<char>(
+        { "\"a\nA\",b\n1,2"sv, "\"a\nA\",b\n3,4\n"sv,
+          "\"a\"\"\r\nA\",b\r\n5,6\r\n"sv, "\"a\nA\",b\r"sv,
+          "\"a\nA\",b\r7,8\n"sv }),
+        concat_header::drop_csv);
+    ASSERT_EQ("\"a\nA\",b\n1,2\n3,4\n5,6\r\n7,8\n", read_all(in, GetParam()));
+}
+
+TEST_P(TestConcatInput, DropCsvDialect)
+{
+    // Single quotes enclose the line break in the header record, and double
+    // quotes are ordinary chars
+    using dialect_t = csv_dialect<';', '\''>;
+    concat_input<string_input<char>, dialect_t> in(make_inputs<char>(
+        { "'a\nA';b\n1;2"sv, "'a\nA';b\n3;4\n"sv, "\"a\nb;c\n5;6\n"sv,
+          "'a''\r\nA';b\r\n7;8\n"sv }),
+        concat_header::drop_csv);
+    ASSERT_EQ("'a\nA';b\n1;2\n3;4\nb;c\n5;6\n7;8\n", read_all(in, GetParam()));
+}
+
+TEST_P(TestConcatInput, DropTsv)
+{
+    concat_input in(make_inputs<wchar_t>(
+        { L"\"a\tb\n1\t2\n"sv, L"\"a\tb\n3\t4\n"sv }),
+        concat_header::drop_tsv);
+    ASSERT_EQ(L"\"a\tb\n1\t2\n3\t4\n", read_all(in, GetParam()));
+}
+
+TEST_P(TestConcatInput, DropAfterEmpty)
+{
+    concat_input in(make_inputs<char>(
+        { ""sv, "a,b\n1,2\n"sv, ""sv, "a,b"sv, "a,b\n3,4\n"sv }),
+        concat_header::drop_csv);
+    ASSERT_EQ("a,b\n1,2\n3,4\n", read_all(in, GetParam()));
+}
+
+TEST_P(TestConcatInput, PartialRead)
+{
+    piecewise_streambuf<char> sb1({ "a,", "b\r", "", "\n1,2" });
+    piecewise_streambuf<char> sb2({ "a,b\r", "", "\n3,4\n" });
+    std::vector<partial_read_input<std::streambuf>> inputs;
+    inputs.push_back(make_char_input(partial_read, sb1));
+    inputs.push_back(make_char_input(partial_read, sb2));
+    concat_input in(std::move(inputs), concat_header::drop_csv);
+    ASSERT_EQ("a,b\r\n1,2\n3,4\n", read_all(in, GetParam()));
+}
+
+TEST_P(TestConcatInput, ParseCsv)
+{
+    const std::vector<std::string_view> texts = {
+        "name,value\nx,1\ny,2\n"sv, "name,value\nz,3"sv,
+        "name,value\r\nw,\"4\n\"\n"sv
+    };
+    std::vector<std::vector<std::string>> field_values;
+    ASSERT_TRUE(parse_csv(concat_input(make_inputs(texts),
+            concat_header::drop_csv),
+        test_collector<char>(field_values), GetParam()));
+    const std::vector<std::vector<std::string>> expected = {
+        { "name", "value" }, { "x", "1" }, { "y", "2" }, { "z", "3" },
+        { "w", "4\n" }
+    };
+    ASSERT_EQ(expected, field_values);
+}
+
+TEST_P(TestConcatInput, ParseCsvDialect)
+{
+    using dialect_t = csv_dialect<';', '\''>;
+    const std::vector<std::string_view> texts = {
+        "'na\nme';value\nx;1\n"sv, "'na\nme';value\ny;'\"2\n'"sv
+    };
+    std::vector<std::vector<std::string>> field_values;
+    ASSERT_TRUE(parse_csv(make_csv_source<dialect_t>(
+            concat_input<string_input<char>, dialect_t>(make_inputs(texts),
+                concat_header::drop_csv)),
+        test_collector<char>(field_values), GetParam()));
+    const std::vector<std::vector<std::string>> expected = {
+        { "na\nme", "value" }, { "x", "1" }, { "y", "\"2\n" }
+    };
+    ASSERT_EQ(expected, field_values);
+}
+
+INSTANTIATE_TEST_SUITE_P(, TestConcatInput, testing::Values(1, 2, 3, 64));
+
+struct TestConcatInputMisc : BaseTest
+{};
+
+TEST_F(TestConcatInputMisc, Swap)
+{
+    concat_input in1(make_inputs<char>({ "ab"sv, "cd"sv }));
+    concat_input<string_input<char>> in2;
+    char b[3];
+    ASSERT_EQ(3U, in1(b, 3));
+    swap(in1, in2);
+    ASSERT_EQ(0U, in1(b, 3));
+    ASSERT_EQ(2U, in2(b, 3));
+    ASSERT_EQ("cd"sv, std::string_view(b, 2));
+    ASSERT_EQ(2U, in2.base().size());
+}
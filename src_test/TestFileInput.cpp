@@ -0,0 +1,381 @@
+/**
+ * These codes are licensed under the Unlicense.
+ * http://unlicense.org
+ */
+
+#include <commata/file_input.hpp>
+
+#ifdef COMMATA_FILE_INPUT_AVAILABLE
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <commata/parse_csv.hpp>
+#include <commata/parse_tsv.hpp>
+
+#include "BaseTest.hpp"
+#include "test_collector.hpp"
+
+using namespace std::string_view_literals;
+
+using namespace commata;
+using namespace commata::test;
+
+static_assert(std::is_trivially_copyable_v<fd_input<char>>);
+static_assert(std::is_trivially_copyable_v<range_input<char>>);
+
+namespace {
+
+// Creates a temporary file with the specified content and removes it on the
+// destruction
+class temporary_file
+{
+    std::string path_;
+
+public:
+    explicit temporary_file(std::string_view content)
+    {
+        const char* const dir = std::getenv("TMPDIR");
+        path_ = (dir ? dir : "/tmp");
+        path_ += "/commata_test_XXXXXX";
+        const int fd = ::mkstemp(path_.data());
+        if (fd == -1) {
+            throw std::system_error(errno, std::generic_category(), "mkstemp");
+        }
+        while (!content.empty()) {
+            const auto n = ::write(fd, content.data(), content.size());
+            if (n <= 0) {
+                ::close(fd);
+                throw std::system_error(errno, std::generic_category(),
+                    "write");
+            }
+            content.remove_prefix(static_cast<std::size_t>(n));
+        }
+        ::close(fd);
+    }
+
+    temporary_file(const temporary_file&) = delete;
+
+    ~temporary_file()
+    {
+        ::unlink(path_.c_str());
+    }
+
+    const std::string& path() const noexcept
+    {
+        return path_;
+    }
+};
+
+// Makes a text whose records lie across window boundaries
+std::string make_text(std::size_t size)
+{
+    std::string s;
+    for (std::size_t i = 0; s.size() < size; ++i) {
+        s += std::to_string(i);
+        s += (i % 7 == 6) ? "\n" : ",\"x\ny\",";
+    }
+    return s;
+}
+
+} // end unnamed
+
+struct TestFdInput : BaseTest
+{};
+
+TEST_F(TestFdInput, Read)
+{
+    temporary_file file("1234567");
+    const int fd = ::open(file.path().c_str(), O_RDONLY);
+    ASSERT_NE(-1, fd);
+    fd_input<char> in(fd);
+    char b[5];
+
+    ASSERT_EQ(4U, in(b, 4));    // reads 1234
+    b[4] = '\0';
+    ASSERT_STREQ("1234", b);
+    ASSERT_EQ(3U, in(b, 4));    // reads 567
+    b[3] = '\0';
+    ASSERT_STREQ("567", b);
+    ASSERT_EQ(0U, in(b, 4));
+    ::close(fd);
+}
+
+TEST_F(TestFdInput, Pread)
+{
+    temporary_file file("1234567");
+    const int fd = ::open(file.path().c_str(), O_RDONLY);
+    ASSERT_NE(-1, fd);
+    fd_input<char> in(fd, 2);
+    char b[5];
+
+    ASSERT_EQ(3U, in(b, 3));    // reads 345
+    b[3] = '\0';
+    ASSERT_STREQ("345", b);
+    ASSERT_EQ(2U, in(b, 4));    // reads 67
+    b[2] = '\0';
+    ASSERT_STREQ("67", b);
+    ASSERT_EQ(0U, in(b, 4));
+
+    // The offset of the file descriptor itself is not moved
+    fd_input<char> in2(fd);
+    ASSERT_EQ(4U, in2(b, 4));   // reads 1234
+    b[4] = '\0';
+    ASSERT_STREQ("1234", b);
+    ::close(fd);
+}
+
+TEST_F(TestFdInput, Error)
+{
+    fd_input<char> in(-2);
+    char b[4];
+    ASSERT_THROW(in(b, 4), std::system_error);
+}
+
+TEST_F(TestFdInput, ParseCsv)
+{
+    const auto s = make_text(100000);
+    temporary_file file(s);
+
+    std::vector<std::vector<std::string>> expected;
+    ASSERT_TRUE(parse_csv(s, test_collector<const char>(expected)));
+
+    const int fd = ::open(file.path().c_str(), O_RDONLY);
+    ASSERT_NE(-1, fd);
+    std::vector<std::vector<std::string>> field_values;
+    ASSERT_TRUE(make_csv_source(fd_input<char>(fd))
+        (test_collector<const char>(field_values))());
+    ::close(fd);
+    ASSERT_EQ(expected, field_values);
+}
+
+struct TestRangeInput : BaseTest
+{};
+
+TEST_F(TestRangeInput, Read)
+{
+    temporary_file file("1234567");
+    const int fd = ::open(file.path().c_str(), O_RDONLY);
+    ASSERT_NE(-1, fd);
+    char b[5];
+
+    range_input<char> in(fd, 2, 3);
+    ASSERT_EQ(2U, in(b, 2));    // reads 34
+    ASSERT_EQ("34"sv, std::string_view(b, 2));
+    ASSERT_EQ(1U, in(b, 4));    // reads 5
+    ASSERT_EQ('5', b[0]);
+    ASSERT_EQ(0U, in(b, 4));
+
+    // The file is shorter than the range
+    range_input<char> in2(fd, 5, 10);
+    ASSERT_EQ(2U, in2(b, 4));   // reads 67
+    ASSERT_EQ("67"sv, std::string_view(b, 2));
+    ASSERT_EQ(0U, in2(b, 4));
+    ::close(fd);
+}
+
+TEST_F(TestRangeInput, SnapKnownUnquoted)
+{
+    temporary_file file("ab,c\r\nde\rf\ng\n");
+    const int fd = ::open(file.path().c_str(), O_RDONLY);
+    ASSERT_NE(-1, fd);
+    const std::pair<::off_t, ::off_t> expected[] = {
+        { 0, 0 }, { 1, 6 }, { 4, 6 }, { 5, 6 }, { 6, 6 }, { 7, 9 },
+        { 9, 9 }, { 10, 11 }, { 12, 13 }, { 13, 13 }, { 20, 20 }
+    };
+    for (const auto& [offset, start] : expected) {
+        const auto r = snap_to_record(fd, offset, record_snap::known_unquoted);
+        ASSERT_EQ(start, r.offset) << offset;
+        ASSERT_FALSE(r.speculative) << offset;
+    }
+    ::close(fd);
+}
+
+TEST_F(TestRangeInput, SnapSpeculative)
+{
+    temporary_file file("a,\"x\ny\nz\",b\nc,d\n");
+    const int fd = ::open(file.path().c_str(), O_RDONLY);
+    ASSERT_NE(-1, fd);
+    const std::pair<::off_t, ::off_t> expected[] = {
+        { 1, 12 }, { 3, 12 }, { 5, 12 }, { 7, 12 }, { 11, 12 }, { 12, 12 },
+        { 13, 16 }
+    };
+    for (const auto& [offset, start] : expected) {
+        const auto r = snap_to_record(fd, offset);
+        ASSERT_EQ(start, r.offset) << offset;
+        ASSERT_FALSE(r.speculative) << offset;
+    }
+    ::close(fd);
+}
+
+TEST_F(TestRangeInput, SnapDialect)
+{
+    // Single quotes enclose the line breaks, and double quotes are ordinary
+    // chars
+    temporary_file file("a;'x\ny\nz\"';b\nc;d\n");
+    const int fd = ::open(file.path().c_str(), O_RDONLY);
+    ASSERT_NE(-1, fd);
+    const std::pair<::off_t, ::off_t> expected[] = {
+        { 1, 13 }, { 3, 13 }, { 5, 13 }, { 7, 13 }, { 12, 13 }, { 13, 13 },
+        { 14, 17 }
+    };
+    for (const auto& [offset, start] : expected) {
+        const auto r = snap_to_record<char, std::char_traits<char>,
+            csv_dialect<';', '\''>>(fd, offset);
+        ASSERT_EQ(start, r.offset) << offset;
+        ASSERT_FALSE(r.speculative) << offset;
+    }
+    ::close(fd);
+}
+
+TEST_F(TestRangeInput, SnapGuess)
+{
+    // Quotation marks next to structural chars do not tell whether they are
+    // opening ones or closing ones
+    temporary_file file("x\n\"\",\"\"\ny\n");
+    const int fd = ::open(file.path().c_str(), O_RDONLY);
+    ASSERT_NE(-1, fd);
+
+    const auto r1 = snap_to_record(fd, 1, record_snap::speculative, 2);
+    ASSERT_EQ(2, r1.offset);
+    ASSERT_TRUE(r1.speculative);
+
+    // The end of the file tells it
+    const auto r2 = snap_to_record(fd, 1);
+    ASSERT_EQ(2, r2.offset);
+    ASSERT_FALSE(r2.speculative);
+    ::close(fd);
+}
+
+TEST_F(TestRangeInput, ParseCsvPartitioned)
+{
+    const auto s = make_text(100000);
+    temporary_file file(s);
+
+    std::vector<std::vector<std::string>> expected;
+    ASSERT_TRUE(parse_csv(s, test_collector<const char>(expected)));
+
+    const int fd = ::open(file.path().c_str(), O_RDONLY);
+    ASSERT_NE(-1, fd);
+    const auto size = static_cast<::off_t>(s.size());
+    std::vector<::off_t> starts;
+    for (::off_t i = 0; i < 8; ++i) {
+        const auto r = snap_to_record(fd, size * i / 8);
+        ASSERT_FALSE(r.speculative);
+        starts.push_back(r.offset);
+    }
+    starts.push_back(size);
+
+    std::vector<std::vector<std::string>> field_values;
+    for (std::size_t i = 0; i + 1 < starts.size(); ++i) {
+        ASSERT_TRUE(make_csv_source(
+                range_input<char>(fd, starts[i], starts[i + 1] - starts[i]))
+            (test_collector<const char>(field_values))());
+    }
+    ::close(fd);
+    ASSERT_EQ(expected, field_values);
+}
+
+struct TestMmapInput : BaseTest
+{};
+
+TEST_F(TestMmapInput, Windows)
+{
+    const auto s = make_text(3 * mmap_input<char>::min_window_size + 10);
+    temporary_file file(s);
+    mmap_input<char> in(file.path(), 1);
+    ASSERT_EQ(mmap_input<char>::min_window_size, in.get_window_size());
+
+    std::string read;
+    while (!in.eof()) {
+        const auto [p, length] = in(static_cast<std::size_t>(-1));
+        ASSERT_GT(length, 0U);
+        ASSERT_LE(length, in.get_window_size());
+        read.append(p, length);
+    }
+    ASSERT_EQ(s, read);
+    ASSERT_EQ(0U, in(10).second);
+}
+
+TEST_F(TestMmapInput, Copy)
+{
+    temporary_file file("1234567");
+    mmap_input<char> in(file.path());
+    char b[5];
+
+    ASSERT_EQ(4U, in(b, 4));    // reads 1234
+    ASSERT_FALSE(in.eof());
+    ASSERT_EQ(3U, in(b, 4));    // reads 567
+    b[3] = '\0';
+    ASSERT_STREQ("567", b);
+    ASSERT_TRUE(in.eof());
+    ASSERT_EQ(0U, in(b, 4));
+}
+
+TEST_F(TestMmapInput, Empty)
+{
+    temporary_file file("");
+    mmap_input<char> in(file.path());
+    ASSERT_TRUE(in.eof());
+    ASSERT_EQ(0U, in(10).second);
+
+    mmap_input<char> in2;
+    ASSERT_TRUE(in2.eof());
+}
+
+TEST_F(TestMmapInput, Move)
+{
+    temporary_file file("123");
+    mmap_input<char> in(file.path());
+    ASSERT_EQ("1"sv, std::string_view(in(1).first, 1));
+    mmap_input<char> in2(std::move(in));
+    ASSERT_TRUE(in.eof());
+    const auto r = in2(10);
+    ASSERT_EQ("23"sv, std::string_view(r.first, r.second));
+}
+
+TEST_F(TestMmapInput, NoFile)
+{
+    ASSERT_THROW(mmap_input<char>("/nonexistent/commata_test"),
+        std::system_error);
+}
+
+TEST_F(TestMmapInput, ParseCsv)
+{
+    const auto s = make_text(2 * mmap_input<char>::min_window_size + 10);
+    temporary_file file(s);
+
+    std::vector<std::vector<std::string>> expected;
+    ASSERT_TRUE(parse_csv(s, test_collector<const char>(expected)));
+
+    std::vector<std::vector<std::string>> field_values;
+    ASSERT_TRUE(make_csv_source(mmap_input<char>(file.path(), 1))
+        (test_collector<const char>(field_values))());
+    ASSERT_EQ(expected, field_values);
+}
+
+TEST_F(TestMmapInput, ParseTsv)
+{
+    temporary_file file("A\tB\nC\tD\n");
+    std::vector<std::vector<std::string>> field_values;
+    ASSERT_TRUE(make_tsv_source(mmap_input<char>(file.path()))
+        (test_collector<const char>(field_values))());
+    const std::vector<std::vector<std::string>> expected = {
+        { "A", "B" }, { "C", "D" }
+    };
+    ASSERT_EQ(expected, field_values);
+}
+
+#endif
@@ -6,24 +6,30 @@
 #include <cstddef>
 #include <exception>
 #include <functional>
+#include <iterator>
 #include <memory>
+#include <optional>
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 #include <vector>
 
 #include <gtest/gtest.h>
 
+#include <commata/encoding_error.hpp>
 #include <commata/parse_csv.hpp>
 #include <commata/wrapper_handlers.hpp>
 
 #include "BaseTest.hpp"
 #include "fancy_allocator.hpp"
 #include "logging_allocator.hpp"
+#include "piecewise_streambuf.hpp"
 #include "tracking_allocator.hpp"
 #include "simple_transcriptor.hpp"
+#include "test_collector.hpp"
 
 using namespace std::string_view_literals;
 
@@ -36,48 +42,6 @@ static_assert(std::is_nothrow_copy_assignable_v<parse_error>);
 
 static_assert(std::is_trivially_copyable_v<csv_source<streambuf_input<char>>>);
 
-template <class Ch>
-class test_collector
-{
-    std::vector<std::vector<std::basic_string<Ch>>>* field_values_;
-    std::basic_string<Ch> field_value_;
-
-public:
-    using char_type = Ch;
-
-    explicit test_collector(
-        std::vector<std::vector<std::basic_string<Ch>>>& field_values) :
-        field_values_(&field_values)
-    {}
-
-    void start_record(const Ch* /*record_begin*/)
-    {
-        field_values_->emplace_back();
-    }
-
-    void update(const Ch* first, const Ch* last)
-    {
-        field_value_.append(first, last);
-    }
-
-    void finalize(const Ch* first, const Ch* last)
-    {
-        field_value_.append(first, last);
-        field_values_->back().emplace_back();
-        field_values_->back().back().swap(field_value_);
-            // field_value_ is cleared here
-    }
-
-    void end_record(const Ch* /*record_end*/)
-    {}
-
-protected:
-    const std::basic_string<Ch>& field_value() const noexcept
-    {
-        return field_value_;
-    }
-};
-
 struct test_collector_empty_line_aware : test_collector<char>
 {
     using test_collector::test_collector;
@@ -384,6 +348,79 @@ TEST_P(TestParseCsvBasics, PrefersNonconstWhenIndirect)
         "{{((Name))((Mass))}}{{((Earth))((1))}}?{{((Moon))((0.0123))}}"sv);
 }
 
+TEST_P(TestParseCsvBasics, LongValues)
+{
+    // Values long enough to span over several blocks of characters which
+    // may be examined at once
+    std::vector<std::string> values;
+    for (const std::size_t n :
+            { 1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 100 }) {
+        values.emplace_back(n, static_cast<char>('a' + n % 26));
+    }
+    std::string s;
+    for (const auto& value : values) {
+        s += value;
+        s += ',';
+    }
+    s.back() = '\n';
+    for (const auto& value : values) {
+        s += '"';
+        s += value;
+        s += "\r\n\"\",";
+        s += value;
+        s += "\",";
+    }
+    s.back() = '\n';
+
+    std::vector<std::vector<std::string>> field_values;
+    test_collector<char> collector(field_values);
+    ASSERT_TRUE(parse_csv(std::istringstream(s), collector, GetParam()));
+    ASSERT_EQ(2U, field_values.size());
+    ASSERT_EQ(values, field_values[0]);
+    ASSERT_EQ(values.size(), field_values[1].size());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        ASSERT_EQ(values[i] + "\r\n\"," + values[i], field_values[1][i])
+            << i;
+    }
+
+    std::vector<std::vector<std::string>> field_values_direct;
+    test_collector<char> collector_direct(field_values_direct);
+    ASSERT_TRUE(parse_csv(s, collector_direct, GetParam()));
+    ASSERT_EQ(field_values, field_values_direct);
+}
+
+TEST_P(TestParseCsvBasics, LongValuesWide)
+{
+    const std::wstring value(40, L'\x3042');
+    const std::wstring s = value + L',' + value + L"\n\""
+                         + value + L"\"\"" + value + L"\"";
+    std::vector<std::vector<std::wstring>> field_values;
+    test_collector<wchar_t> collector(field_values);
+    ASSERT_TRUE(parse_csv(s, collector, GetParam()));
+    ASSERT_EQ(2U, field_values.size());
+    const std::vector<std::wstring> expected_row0 = { value, value };
+    ASSERT_EQ(expected_row0, field_values[0]);
+    const std::vector<std::wstring> expected_row1 =
+        { value + L'"' + value };
+    ASSERT_EQ(expected_row1, field_values[1]);
+}
+
+TEST_P(TestParseCsvBasics, LongValueError)
+{
+    const std::string s = "A,B\n" + std::string(70, 'x') + "\"";
+    std::vector<std::vector<std::string>> field_values;
+    test_collector<char> collector(field_values);
+    try {
+        parse_csv(std::istringstream(s), collector, GetParam());
+        FAIL();
+    } catch (const parse_error& e) {
+        const auto pos = e.get_physical_position();
+        ASSERT_TRUE(pos.has_value());
+        ASSERT_EQ(1U, pos->first);
+        ASSERT_EQ(70U, pos->second);
+    }
+}
+
 namespace {
 
 class aborting_handler
@@ -467,6 +504,66 @@ TEST_P(TestParseCsvBasics, ParsePointAbortFinalize)
     ASSERT_EQ(l.size(), get_parse_point(r));
 }
 
+namespace {
+
+// Records the names of its member functions called and aborts on a value
+// "STOP"
+class stopping_handler
+{
+    std::vector<std::string>* calls_;
+    std::string value_;
+
+public:
+    using char_type = char;
+
+    explicit stopping_handler(std::vector<std::string>& calls) :
+        calls_(&calls)
+    {}
+
+    void start_record(const char* /*record_begin*/)
+    {
+        calls_->emplace_back("start_record");
+    }
+
+    void end_record(const char* /*record_end*/)
+    {
+        calls_->emplace_back("end_record");
+    }
+
+    void update(const char* first, const char* last)
+    {
+        value_.append(first, last);
+    }
+
+    bool finalize(const char* first, const char* last)
+    {
+        update(first, last);
+        calls_->emplace_back("finalize " + value_);
+        const bool ret = (value_ != "STOP");
+        value_.clear();
+        return ret;
+    }
+};
+
+}
+
+TEST_P(TestParseCsvBasics, NoCallsAfterAbort)
+{
+    for (const auto& [l, r] : {
+            std::pair("A,STOP"sv, "\nB\n"sv),
+            std::pair("A,STOP"sv, ""sv),
+            std::pair("A,\"STOP\""sv, "\r\nB"sv) }) {
+        std::vector<std::string> calls;
+        const auto result = make_csv_source(std::string(l) + std::string(r))
+            (stopping_handler(calls), GetParam())();
+        ASSERT_FALSE(result) << l << r;
+        ASSERT_EQ(l.size(), get_parse_point(result)) << l << r;
+        const std::vector<std::string> expected =
+            { "start_record", "finalize A", "finalize STOP" };
+        ASSERT_EQ(expected, calls) << l << r;
+    }
+}
+
 INSTANTIATE_TEST_SUITE_P(,
     TestParseCsvBasics, testing::Values(1, 10, 1024));
 
@@ -587,6 +684,36 @@ TEST_P(TestParseCsvErrors, Errors)
     }
 }
 
+TEST_P(TestParseCsvErrors, ErrorCodes)
+{
+    std::string message;
+    try {
+        std::vector<std::vector<std::string>> field_values;
+        parse_csv(std::string(GetParam().first),
+            test_collector<char>(field_values), 4);
+        FAIL();
+    } catch (const parse_error& e) {
+        message = e.what();
+    }
+
+    std::vector<std::vector<std::string>> field_values;
+    parse_failure failure;
+    ASSERT_FALSE(parse_csv(failure, std::string(GetParam().first),
+        test_collector<char>(field_values), 4));
+    ASSERT_TRUE(failure);
+    ASSERT_EQ(&parse_error_category(), &failure.get_error_code().category());
+    ASSERT_EQ(message, failure.get_error_code().message());
+    const auto pos = failure.get_physical_position();
+    ASSERT_TRUE(pos.has_value());
+    ASSERT_EQ(GetParam().second, *pos);
+
+    // Successful parsing clears the failure
+    ASSERT_TRUE(parse_csv(failure, "col1,\"col2\"\n"sv,
+        test_collector<char>(field_values)));
+    ASSERT_FALSE(failure);
+    ASSERT_FALSE(failure.get_physical_position().has_value());
+}
+
 INSTANTIATE_TEST_SUITE_P(, TestParseCsvErrors,
     testing::Values(
         std::make_pair("col\"1\"", std::make_pair(0, 3)),
@@ -594,6 +721,563 @@ INSTANTIATE_TEST_SUITE_P(, TestParseCsvErrors,
         std::make_pair("\"col1\",\"", std::make_pair(0, 8)),
         std::make_pair("col1\r\n\n\"col2\"a", std::make_pair(2, 6))));
 
+struct TestParseCsvErrorCodes : BaseTest
+{};
+
+TEST_F(TestParseCsvErrorCodes, Values)
+{
+    std::vector<std::vector<std::string>> field_values;
+    parse_failure failure;
+
+    ASSERT_FALSE(parse_csv(failure, "a,b\nc\"d\"\n"sv,
+        test_collector<char>(field_values)));
+    ASSERT_EQ(parse_errc::quotation_mark_in_unquoted_value,
+        failure.get_error_code());
+
+    ASSERT_FALSE(parse_csv(failure, "\"a\"b"sv,
+        test_collector<char>(field_values)));
+    ASSERT_EQ(parse_errc::invalid_char_after_quoted_value,
+        failure.get_error_code());
+
+    field_values.clear();
+    ASSERT_FALSE(parse_csv(failure, "a,b\n\"c\n"sv,
+        test_collector<char>(field_values)));
+    ASSERT_EQ(parse_errc::eof_in_quoted_value, failure.get_error_code());
+    // No more handler calls are made after the malformation
+    const std::vector<std::vector<std::string>> expected = {
+        { "a", "b" }, {}
+    };
+    ASSERT_EQ(expected, field_values);
+}
+
+struct TestParseCsvIndexed :
+    commata::test::BaseTestWithParam<std::size_t>
+{};
+
+TEST_P(TestParseCsvIndexed, SameAsSequential)
+{
+    // Quotation marks, commas in quoted values and line terminators are
+    // scattered so that they lie on various positions of the blocks and the
+    // windows of the structural index
+    const char* const pieces[] = {
+        "a", ",", "\"", "\"\"", "b,c", "\r\n", "\n", "\r", "xyz",
+        "\"\",\"\"", ",,", "\"\r\n\"", "d\"\"e"
+    };
+    std::string s;
+    unsigned n = 0;
+    bool quoted = false;
+    for (std::size_t i = 0; i < 6000; ++i) {
+        n = n * 1103515245U + 12345U;
+        std::string_view piece = pieces[(n >> 16) % std::size(pieces)];
+        if (!quoted && (piece.find('"') != std::string_view::npos)) {
+            piece = "\"";
+        }
+        if (piece == "\"") {
+            s += quoted ? "\"," : ",\"";
+            quoted = !quoted;
+        } else if (quoted || (piece.find('"') == std::string_view::npos)) {
+            s += piece;
+        }
+        if (i % 97 == 0) {
+            s.append((n >> 8) % 200, 'f');
+        }
+    }
+    if (quoted) {
+        s += '"';
+    }
+
+    std::vector<std::vector<std::string>> expected;
+    test_collector<char> collector(expected);
+    ASSERT_TRUE(parse_csv(s, collector, GetParam()));
+    ASSERT_GT(expected.size(), 1U);
+
+    std::vector<std::vector<std::string>> field_values;
+    test_collector<char> collector_indexed(field_values);
+    ASSERT_TRUE(make_csv_source<csv_indexed_engine>(std::istringstream(s))
+        (collector_indexed, GetParam())());
+    ASSERT_EQ(expected, field_values);
+
+    std::vector<std::vector<std::string>> field_values_direct;
+    test_collector<char> collector_direct(field_values_direct);
+    ASSERT_TRUE(make_csv_source<csv_indexed_engine>(s)(collector_direct)());
+    ASSERT_EQ(expected, field_values_direct);
+}
+
+TEST_P(TestParseCsvIndexed, Wide)
+{
+    const std::wstring value(70, L'\x3042');
+    const std::wstring s = value + L',' + value + L"\r\n\""
+                         + value + L",\"\"" + value + L"\"," + value;
+    std::vector<std::vector<std::wstring>> field_values;
+    test_collector<wchar_t> collector(field_values);
+    ASSERT_TRUE(make_csv_source<csv_indexed_engine>(std::wistringstream(s))
+        (collector, GetParam())());
+    ASSERT_EQ(2U, field_values.size());
+    const std::vector<std::wstring> expected_row0 = { value, value };
+    ASSERT_EQ(expected_row0, field_values[0]);
+    const std::vector<std::wstring> expected_row1 =
+        { value + L",\"" + value, value };
+    ASSERT_EQ(expected_row1, field_values[1]);
+}
+
+TEST_P(TestParseCsvIndexed, Errors)
+{
+    const std::pair<std::string, std::pair<std::size_t, std::size_t>>
+            cases[] = {
+        { "col\"1\"", { 0, 3 } },
+        { "\"col1", { 0, 5 } },
+        { "A,B\n" + std::string(70, 'x') + "\"", { 1, 70 } },
+        { "\"" + std::string(100, ',') + "\"\"" + std::string(5000, 'y')
+            + "\"z", { 0, 5104 } }
+    };
+    for (const auto& [s, expected] : cases) {
+        std::vector<std::vector<std::string>> field_values;
+        test_collector<char> collector(field_values);
+        try {
+            make_csv_source<csv_indexed_engine>(std::istringstream(s))
+                (collector, GetParam())();
+            FAIL() << s;
+        } catch (const parse_error& e) {
+            const auto pos = e.get_physical_position();
+            ASSERT_TRUE(pos.has_value());
+            ASSERT_EQ(expected.first, pos->first) << s;
+            ASSERT_EQ(expected.second, pos->second) << s;
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(,
+    TestParseCsvIndexed, testing::Values(1, 10, 63, 64, 65, 1024, 5000));
+
+struct TestParseCsvDialect :
+    commata::test::BaseTestWithParam<std::size_t>
+{};
+
+TEST_P(TestParseCsvDialect, SemicolonAndApostrophe)
+{
+    const std::string s = "a;'b;''c'\r\n'\"d\r\n';e,\n";
+    const std::vector<std::vector<std::string>> expected = {
+        { "a", "b;'c" }, { "\"d\r\n", "e," }
+    };
+    using dialect_t = csv_dialect<';', '\''>;
+
+    std::vector<std::vector<std::string>> field_values;
+    test_collector<char> collector(field_values);
+    ASSERT_TRUE(make_csv_source<dialect_t>(std::istringstream(s))
+        (collector, GetParam())());
+    ASSERT_EQ(expected, field_values);
+
+    std::vector<std::vector<std::string>> field_values_indexed;
+    test_collector<char> collector_indexed(field_values_indexed);
+    ASSERT_TRUE((make_csv_source<csv_indexed_engine, dialect_t>(
+        std::istringstream(s))(collector_indexed, GetParam())()));
+    ASSERT_EQ(expected, field_values_indexed);
+}
+
+TEST_P(TestParseCsvDialect, UnitSeparators)
+{
+    // US as the delimiter, RS as the record terminator and SOH as CR, which
+    // never appears
+    const std::wstring s =
+        L"A\x1f\"B\x1e\"\x1e\x1e" L"C,D\x1f\x1f\x1e";
+    using dialect_t = csv_dialect<'\x1f', '"', '\x01', '\x1e'>;
+    std::vector<std::vector<std::wstring>> field_values;
+    test_collector<wchar_t> collector(field_values);
+    ASSERT_TRUE(make_csv_source<dialect_t>(std::wistringstream(s))
+        (collector, GetParam())());
+    const std::vector<std::vector<std::wstring>> expected = {
+        { L"A", L"B\x1e" }, { L"C,D", L"", L"" }
+    };
+    ASSERT_EQ(expected, field_values);
+}
+
+TEST_P(TestParseCsvDialect, Error)
+{
+    const std::string s = "a|b\nc|d'e";
+    std::vector<std::vector<std::string>> field_values;
+    test_collector<char> collector(field_values);
+    try {
+        make_csv_source<csv_dialect<'|', '\''>>(std::istringstream(s))
+            (collector, GetParam())();
+        FAIL();
+    } catch (const parse_error& e) {
+        const auto pos = e.get_physical_position();
+        ASSERT_TRUE(pos.has_value());
+        ASSERT_EQ(1U, pos->first);
+        ASSERT_EQ(3U, pos->second);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(,
+    TestParseCsvDialect, testing::Values(1, 10, 1024));
+
+struct TestParseCsvUtf8Validation :
+    commata::test::BaseTestWithParam<std::size_t>
+{};
+
+namespace {
+
+// Parses s with the options and returns the records and the byte offset and
+// the physical position of the invalid sequence, if any
+template <class... Options>
+auto parse_utf8(const std::string& s, std::size_t buffer_size)
+{
+    std::vector<std::vector<std::string>> field_values;
+    std::optional<std::tuple<std::string, std::size_t, std::size_t>> error;
+    try {
+        parse_csv(make_csv_source<csv_utf8_validation, Options...>(
+                std::istringstream(s)),
+            test_collector<char>(field_values), buffer_size);
+    } catch (const encoding_error& e) {
+        const auto pos = e.get_physical_position();
+        error.emplace(e.what(), pos->first, pos->second);
+    }
+    return std::make_pair(field_values, error);
+}
+
+// The same as parse_utf8 except that this has the invalid sequence reported
+// to a parse_failure object
+template <class... Options>
+auto parse_utf8_failure(const std::string& s, std::size_t buffer_size)
+{
+    std::vector<std::vector<std::string>> field_values;
+    parse_failure failure;
+    const bool result = parse_csv(failure,
+        make_csv_source<csv_utf8_validation, Options...>(
+            std::istringstream(s)),
+        test_collector<char>(field_values), buffer_size);
+    return std::make_tuple(result, field_values, failure);
+}
+
+} // end unnamed
+
+TEST_P(TestParseCsvUtf8Validation, Valid)
+{
+    // The BOM is skipped only at the beginning of the text
+    const std::string s = "\xef\xbb\xbf\xe6\x97\xa5,\"\xf0\x9f\x98\x80\n\"\r\n"
+                          "\xef\xbb\xbf\xc3\xa9,\xed\x9f\xbf\xf4\x8f\xbf\xbf";
+    const std::vector<std::vector<std::string>> expected = {
+        { "\xe6\x97\xa5", "\xf0\x9f\x98\x80\n" },
+        { "\xef\xbb\xbf\xc3\xa9", "\xed\x9f\xbf\xf4\x8f\xbf\xbf" }
+    };
+
+    const auto [field_values, error] = parse_utf8<>(s, GetParam());
+    ASSERT_FALSE(error.has_value());
+    ASSERT_EQ(expected, field_values);
+
+    std::vector<std::vector<std::string>> field_values_direct;
+    ASSERT_TRUE(parse_csv(make_csv_source<csv_utf8_validation>(s),
+        test_collector<char>(field_values_direct)));
+    ASSERT_EQ(expected, field_values_direct);
+}
+
+TEST_P(TestParseCsvUtf8Validation, Invalid)
+{
+    // The position is that of the first byte which cannot continue a valid
+    // text, or the end of the text if it ends in the middle of a sequence;
+    // the BOM does not count as a column
+    const std::tuple<std::string, std::size_t, std::size_t, std::size_t>
+            cases[] = {
+        { "a,b\nc,\xff\n", 6, 1, 2 },
+        { "\xef\xbb\xbf" "a,\xe6\x97x", 7, 0, 4 },
+        { "\xc0\xaf", 0, 0, 0 },
+        { "ab\n\"\xed\xa0\x80\"", 5, 1, 2 },
+        { "ab\n\"\xf4\x90\x80\x80\"", 5, 1, 2 },
+        { "ab\n" + std::string(100, 'x') + "\xf0\x9f\x98", 106, 1, 103 }
+    };
+    for (const auto& [s, offset, line, column] : cases) {
+        const auto expected_what =
+            "Invalid UTF-8 sequence at byte offset " + std::to_string(offset);
+        const auto check = [&, &s = s, &line = line, &column = column]
+                (const auto& result) {
+            ASSERT_TRUE(result.second.has_value()) << s;
+            const auto& [what, l, c] = *result.second;
+            ASSERT_EQ(expected_what, what) << s;
+            ASSERT_EQ(line, l) << s;
+            ASSERT_EQ(column, c) << s;
+            // Records before the invalid sequence have been reported
+            ASSERT_GE(result.first.size(), line) << s;
+        };
+        check(parse_utf8<>(s, GetParam()));
+        check(parse_utf8<csv_indexed_engine>(s, GetParam()));
+    }
+}
+
+TEST_P(TestParseCsvUtf8Validation, InvalidToFailure)
+{
+    const std::tuple<std::string, std::size_t, std::size_t> cases[] = {
+        { "a,b\nc,\xff\n", 1, 2 },
+        { "\xef\xbb\xbf" "a,\xe6\x97x", 0, 4 },
+        { "ab\n" + std::string(100, 'x') + "\xf0\x9f\x98", 1, 103 }
+    };
+    for (const auto& [s, line, column] : cases) {
+        const auto check = [&, &s = s, &line = line, &column = column]
+                (const auto& result) {
+            const auto& [r, field_values, failure] = result;
+            ASSERT_FALSE(r) << s;
+            ASSERT_TRUE(failure) << s;
+            ASSERT_EQ(parse_errc::invalid_utf8_sequence,
+                failure.get_error_code()) << s;
+            ASSERT_EQ(std::make_pair(line, column),
+                failure.get_physical_position()) << s;
+            ASSERT_GE(field_values.size(), line) << s;
+        };
+        check(parse_utf8_failure<>(s, GetParam()));
+        check(parse_utf8_failure<csv_indexed_engine>(s, GetParam()));
+    }
+
+    // Direct input
+    std::vector<std::vector<std::string>> field_values;
+    parse_failure failure;
+    ASSERT_FALSE(parse_csv(failure,
+        csv_source<string_input<char>, csv_utf8_validation>(
+            string_input<char>("a,b\nc,\xff\n")),
+        test_collector<char>(field_values)));
+    ASSERT_EQ(parse_errc::invalid_utf8_sequence, failure.get_error_code());
+    ASSERT_EQ(std::make_pair(std::size_t(1), std::size_t(2)),
+        failure.get_physical_position());
+    const std::vector<std::vector<std::string>> expected = {
+        { "a", "b" }, { "c" }
+    };
+    ASSERT_EQ(expected, field_values);
+}
+
+INSTANTIATE_TEST_SUITE_P(,
+    TestParseCsvUtf8Validation, testing::Values(3, 4, 7, 64, 1024));
+
+struct TestParseCsvPartialRead : commata::test::BaseTest
+{};
+
+TEST_F(TestParseCsvPartialRead, RecordsArriveAtOnce)
+{
+    const std::vector<std::string> pieces = { "A,\"B", "\"\nC,", "D\n", "E" };
+    const std::vector<std::vector<std::string>> expected = {
+        { "A", "B" }, { "C", "D" }, { "E" }
+    };
+
+    // The number of records which have been started when each piece arrives
+    std::vector<std::vector<std::string>> field_values;
+    std::vector<std::size_t> record_counts;
+    piecewise_streambuf<char> in(pieces, [&](std::size_t) {
+        record_counts.push_back(field_values.size());
+    });
+    ASSERT_TRUE(parse_csv(partial_read, in,
+        test_collector<char>(field_values), 1024));
+    ASSERT_EQ(expected, field_values);
+    ASSERT_EQ((std::vector<std::size_t>{ 0, 1, 2, 2 }), record_counts);
+
+    // Without partial_read, nothing is parsed before the buffer is filled
+    field_values.clear();
+    record_counts.clear();
+    piecewise_streambuf<char> in2(pieces, [&](std::size_t) {
+        record_counts.push_back(field_values.size());
+    });
+    ASSERT_TRUE(parse_csv(in2, test_collector<char>(field_values), 1024));
+    ASSERT_EQ(expected, field_values);
+    ASSERT_EQ((std::vector<std::size_t>{ 0, 0, 0, 0 }), record_counts);
+}
+
+TEST_F(TestParseCsvPartialRead, Indirect)
+{
+    std::vector<std::vector<std::string>> field_values;
+    piecewise_streambuf<char> in({ "A,B", "\n", "C" });
+    std::istream is(&in);
+    ASSERT_TRUE(parse_csv(make_char_input(indirect, partial_read, is),
+        test_collector<char>(field_values), 2));
+    const std::vector<std::vector<std::string>> expected = {
+        { "A", "B" }, { "C" }
+    };
+    ASSERT_EQ(expected, field_values);
+}
+
+namespace {
+
+// Has a member function eof which has nothing to do with the CharInput
+// requirements
+class eof_unrelated_input
+{
+    std::string_view s_;
+
+public:
+    using char_type = char;
+    using traits_type = std::char_traits<char>;
+    using size_type = std::size_t;
+
+    explicit eof_unrelated_input(std::string_view s) noexcept :
+        s_(s)
+    {}
+
+    size_type operator()(char* out, size_type n)
+    {
+        const auto length = s_.copy(out, n);
+        s_.remove_prefix(length);
+        return length;
+    }
+
+    bool eof() const noexcept
+    {
+        return true;
+    }
+};
+
+}
+
+TEST_F(TestParseCsvPartialRead, EofNotReported)
+{
+    // An input tells the end of the text with eof only if it says so with
+    // its member type reports_eof
+    static_assert(!detail::reports_eof_v<eof_unrelated_input>);
+    static_assert(detail::reports_eof_v<partial_read_input<std::istream>>);
+    static_assert(!detail::reports_eof_v<
+        indirect_input<eof_unrelated_input>>);
+    std::vector<std::vector<std::string>> field_values;
+    ASSERT_TRUE(parse_csv(eof_unrelated_input("A,B\nC,D"),
+        test_collector<char>(field_values), 3));
+    const std::vector<std::vector<std::string>> expected = {
+        { "A", "B" }, { "C", "D" }
+    };
+    ASSERT_EQ(expected, field_values);
+}
+
+struct TestParseCsvDirectRead : commata::test::BaseTest
+{};
+
+TEST_F(TestParseCsvDirectRead, Streambuf)
+{
+    std::vector<std::vector<std::string>> field_values;
+    piecewise_streambuf<char> in({ "A,\"B", "\"\nC,", "D\n", "E" });
+    ASSERT_TRUE(parse_csv(direct_read, in,
+        test_collector<const char>(field_values)));
+    const std::vector<std::vector<std::string>> expected = {
+        { "A", "B" }, { "C", "D" }, { "E" }
+    };
+    ASSERT_EQ(expected, field_values);
+}
+
+TEST_F(TestParseCsvDirectRead, IStream)
+{
+    std::vector<std::vector<std::string>> field_values;
+    std::istringstream in("A,\"B\n\"\"\"\r\nC\n\n");
+    ASSERT_TRUE(parse_csv(direct_read, in,
+        test_collector<const char>(field_values)));
+    const std::vector<std::vector<std::string>> expected = {
+        { "A", "B\n\"" }, { "C" }
+    };
+    ASSERT_EQ(expected, field_values);
+    ASSERT_TRUE(in.eof());
+}
+
+struct TestParseCsvSplitBom :
+    commata::test::BaseTestWithParam<std::size_t>
+{};
+
+TEST_P(TestParseCsvSplitBom, All)
+{
+    // The BOM is skipped even if it arrives in pieces, and the bytes which
+    // begin the BOM but turn out not to be it are parsed as they are
+    const std::pair<std::vector<std::string>,
+                    std::vector<std::vector<std::string>>> cases[] = {
+        { { "\xef\xbb", "\xbf" "a,b\n" }, { { "a", "b" } } },
+        { { "\xef", "\xbb", "\xbf", "a" }, { { "a" } } },
+        { { "\xef", "\xbb\x80,b" }, { { "\xef\xbb\x80", "b" } } },
+        { { "\xef\xbb", "\x80", ",b" }, { { "\xef\xbb\x80", "b" } } },
+        { { "\xef\xbb", "\xbf\xef\xbb\xbf" }, { { "\xef\xbb\xbf" } } }
+    };
+    for (const auto& [pieces, expected] : cases) {
+        {
+            std::vector<std::vector<std::string>> field_values;
+            piecewise_streambuf<char> in(pieces);
+            ASSERT_TRUE(parse_csv(make_csv_source<csv_utf8_validation>(
+                    make_char_input(partial_read, in)),
+                test_collector<char>(field_values), GetParam()));
+            ASSERT_EQ(expected, field_values);
+        }
+        {
+            std::vector<std::vector<std::string>> field_values;
+            piecewise_streambuf<char> in(pieces);
+            ASSERT_TRUE(parse_csv(make_csv_source<csv_utf8_validation>(
+                    make_char_input(direct_read, in)),
+                test_collector<const char>(field_values)));
+            ASSERT_EQ(expected, field_values);
+        }
+    }
+
+    // The held bytes which end the text are invalid
+    std::vector<std::vector<std::string>> field_values;
+    parse_failure failure;
+    piecewise_streambuf<char> in2({ "\xef", "\xbb" });
+    ASSERT_FALSE(parse_csv(failure, make_csv_source<csv_utf8_validation>(
+            make_char_input(direct_read, in2)),
+        test_collector<const char>(field_values)));
+    ASSERT_EQ(parse_errc::invalid_utf8_sequence, failure.get_error_code());
+    ASSERT_EQ(std::make_pair(std::size_t(0), std::size_t(2)),
+        failure.get_physical_position());
+}
+
+INSTANTIATE_TEST_SUITE_P(,
+    TestParseCsvSplitBom, testing::Values(3, 4, 1024));
+
+namespace {
+
+// Suspends the parser at every chance and tells where to the outside
+class yielding_collector : public test_collector<const char>
+{
+    std::size_t* yield_location_;
+
+public:
+    yielding_collector(
+        std::vector<std::vector<std::string>>& field_values,
+        std::size_t& yield_location) :
+        test_collector(field_values), yield_location_(&yield_location)
+    {}
+
+    bool yield(std::size_t location) noexcept
+    {
+        *yield_location_ = location;
+        return true;
+    }
+
+    std::size_t yield_location() const noexcept
+    {
+        return *yield_location_;
+    }
+};
+
+}
+
+struct TestParseCsvSplitBomMove : commata::test::BaseTest
+{};
+
+TEST_F(TestParseCsvSplitBomMove, All)
+{
+    // The held bytes which are parsed on a buffer of their own go along with
+    // the parser when it is moved halfway through them
+    std::vector<std::vector<std::string>> field_values;
+    piecewise_streambuf<char> in({ "\xef\xbb", "\x80,b" });
+    const auto source = make_csv_source<csv_utf8_validation>(
+        make_char_input(direct_read, in));
+    std::size_t yield_location = 0;
+    using parser_t = decltype(
+        source(yielding_collector(field_values, yield_location)));
+    std::optional<parser_t> parsers[2];
+    parsers[0].emplace(
+        source(yielding_collector(field_values, yield_location)));
+    std::vector<std::vector<std::string>> dummy_field_values;
+    std::size_t dummy_yield_location = 0;
+    for (std::size_t i = 0;
+         yield_location != static_cast<std::size_t>(-1); i = 1 - i) {
+        ASSERT_TRUE((*parsers[i])());
+        parsers[1 - i].emplace(std::move(*parsers[i]));
+        // The moved-from parser is overwritten so that nothing is left in it
+        parsers[i].emplace(source(
+            yielding_collector(dummy_field_values, dummy_yield_location)));
+    }
+    const std::vector<std::vector<std::string>> expected = {
+        { "\xef\xbb\x80", "b" }
+    };
+    ASSERT_EQ(expected, field_values);
+}
+
 struct TestParseCsvHandleException : commata::test::BaseTest
 {};
 
@@ -0,0 +1,232 @@
+/**
+ * These codes are licensed under the Unlicense.
+ * http://unlicense.org
+ */
+
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <commata/parse_csv.hpp>
+#include <commata/parse_csv_parallel.hpp>
+
+#include "BaseTest.hpp"
+#include "test_collector.hpp"
+
+using namespace commata;
+using namespace commata::test;
+
+namespace {
+
+// Aborts on a field "ABORT" and throws on a record which starts with "THROW"
+struct failing_collector : test_collector<char>
+{
+    using test_collector::test_collector;
+
+    bool finalize(const char* first, const char* last)
+    {
+        test_collector::finalize(first, last);
+        return last_record().back() != "ABORT";
+    }
+
+    void end_record(const char* /*record_end*/)
+    {
+        if (last_record().front() == "THROW") {
+            throw std::runtime_error("Thrown");
+        }
+    }
+};
+
+// Makes a valid CSV text whose quoted values contain commas and line breaks
+std::string make_text(std::size_t piece_count)
+{
+    const char* const pieces[] = {
+        "a", ",", "\"", "\"\"", "b,c", "\r\n", "\n", "xyz", ",,", "\n\n",
+        "\"\n\"", "d\"\"e"
+    };
+    std::string s;
+    unsigned n = 1;
+    bool quoted = false;
+    for (std::size_t i = 0; i < piece_count; ++i) {
+        n = n * 1103515245U + 12345U;
+        std::string_view piece = pieces[(n >> 16) % std::size(pieces)];
+        if (!quoted && (piece.find('"') != std::string_view::npos)) {
+            piece = "\"";
+        }
+        if (piece == "\"") {
+            s += quoted ? "\"," : ",\"";
+            quoted = !quoted;
+        } else {
+            s += piece;
+        }
+    }
+    if (quoted) {
+        s += '"';
+    }
+    return s;
+}
+
+} // end unnamed
+
+struct TestParseCsvParallel :
+    commata::test::BaseTestWithParam<std::size_t>
+{};
+
+TEST_P(TestParseCsvParallel, SameAsSequential)
+{
+    const auto s = make_text(5000);
+
+    std::vector<std::vector<std::string>> expected;
+    ASSERT_TRUE(parse_csv(s, test_collector<char>(expected)));
+
+    std::vector<std::vector<std::vector<std::string>>> chunks(GetParam());
+    ASSERT_TRUE(parse_csv_parallel(s,
+        [&chunks](std::size_t i) {
+            return test_collector<char>(chunks.at(i));
+        }, GetParam()));
+    std::vector<std::vector<std::string>> field_values;
+    for (const auto& chunk : chunks) {
+        field_values.insert(field_values.cend(), chunk.cbegin(), chunk.cend());
+    }
+    ASSERT_EQ(expected, field_values);
+}
+
+TEST_P(TestParseCsvParallel, Indexed)
+{
+    const std::wstring s =
+        L"\"A\nB\",C\r\nD,\"E,\"\"F\n\"\"\"\nG,H\n\n\"\",\"\n,\n\"\nI";
+    std::vector<std::vector<std::vector<std::wstring>>> chunks(GetParam());
+    ASSERT_TRUE(parse_csv_parallel<csv_indexed_engine>(std::wstring_view(s),
+        [&chunks](std::size_t i) {
+            return test_collector<wchar_t>(chunks.at(i));
+        }, GetParam()));
+    std::vector<std::vector<std::wstring>> field_values;
+    for (const auto& chunk : chunks) {
+        field_values.insert(field_values.cend(), chunk.cbegin(), chunk.cend());
+    }
+    const std::vector<std::vector<std::wstring>> expected = {
+        { L"A\nB", L"C" },
+        { L"D", L"E,\"F\n\"" },
+        { L"G", L"H" },
+        { L"", L"\n,\n" },
+        { L"I" }
+    };
+    ASSERT_EQ(expected, field_values);
+}
+
+TEST_P(TestParseCsvParallel, Dialect)
+{
+    std::string s = make_text(3000);
+    for (auto& c : s) {
+        switch (c) {
+        case ',':
+            c = ';';
+            break;
+        case '"':
+            c = '\'';
+            break;
+        case '\n':
+            c = '|';
+            break;
+        default:
+            break;
+        }
+    }
+    using dialect_t = csv_dialect<';', '\'', '\r', '|'>;
+
+    std::vector<std::vector<std::string>> expected;
+    ASSERT_TRUE(make_csv_source<dialect_t>(s)
+        (test_collector<char>(expected))());
+    ASSERT_GT(expected.size(), 1U);
+
+    std::vector<std::vector<std::vector<std::string>>> chunks(GetParam());
+    ASSERT_TRUE(parse_csv_parallel<dialect_t>(s,
+        [&chunks](std::size_t i) {
+            return test_collector<char>(chunks.at(i));
+        }, GetParam()));
+    std::vector<std::vector<std::string>> field_values;
+    for (const auto& chunk : chunks) {
+        field_values.insert(field_values.cend(), chunk.cbegin(), chunk.cend());
+    }
+    ASSERT_EQ(expected, field_values);
+}
+
+TEST_P(TestParseCsvParallel, Utf8Validation)
+{
+    // Every line but the first starts with a BOM, so do the chunks but the
+    // first one, which must not be skipped there
+    std::string s = "\xef\xbb\xbf" "a\n";
+    for (std::size_t i = 0; i < 100; ++i) {
+        s += "\xef\xbb\xbf" "b,\xc3\xa9\n";
+    }
+
+    std::vector<std::vector<std::string>> expected;
+    ASSERT_TRUE(make_csv_source<csv_utf8_validation>(s)
+        (test_collector<char>(expected))());
+    ASSERT_EQ(101U, expected.size());
+    ASSERT_EQ(std::vector<std::string>{ "a" }, expected.front());
+    ASSERT_EQ((std::vector<std::string>{ "\xef\xbb\xbf" "b", "\xc3\xa9" }),
+        expected.back());
+
+    std::vector<std::vector<std::vector<std::string>>> chunks(GetParam());
+    ASSERT_TRUE(parse_csv_parallel<csv_utf8_validation>(s,
+        [&chunks](std::size_t i) {
+            return test_collector<char>(chunks.at(i));
+        }, GetParam()));
+    std::vector<std::vector<std::string>> field_values;
+    for (const auto& chunk : chunks) {
+        field_values.insert(field_values.cend(), chunk.cbegin(), chunk.cend());
+    }
+    ASSERT_EQ(expected, field_values);
+}
+
+TEST_P(TestParseCsvParallel, Error)
+{
+    const auto head = make_text(3000);
+    const auto s = head + "\n\"AB\"C\nD\n" + make_text(3000);
+
+    std::pair<std::size_t, std::size_t> expected;
+    try {
+        std::vector<std::vector<std::string>> field_values;
+        parse_csv(s, test_collector<char>(field_values));
+        FAIL();
+    } catch (const parse_error& e) {
+        ASSERT_TRUE(e.get_physical_position().has_value());
+        expected = *e.get_physical_position();
+    }
+    ASSERT_EQ(4U, expected.second);
+
+    std::vector<std::vector<std::vector<std::string>>> chunks(GetParam());
+    try {
+        parse_csv_parallel(s,
+            [&chunks](std::size_t i) {
+                return test_collector<char>(chunks.at(i));
+            }, GetParam());
+        FAIL();
+    } catch (const parse_error& e) {
+        ASSERT_TRUE(e.get_physical_position().has_value());
+        ASSERT_EQ(expected, *e.get_physical_position());
+    }
+}
+
+TEST_P(TestParseCsvParallel, FirstFailureWins)
+{
+    const auto filler = make_text(2000);
+    const auto s = "A\n" + filler + "\nABORT\n" + filler + "\nTHROW\n"
+                 + filler;
+
+    std::vector<std::vector<std::vector<std::string>>> chunks(GetParam());
+    ASSERT_FALSE(parse_csv_parallel(s,
+        [&chunks](std::size_t i) {
+            return failing_collector(chunks.at(i));
+        }, GetParam()));
+}
+
+INSTANTIATE_TEST_SUITE_P(,
+    TestParseCsvParallel, testing::Values(1, 2, 3, 7, 16));
@@ -18,6 +18,7 @@
 
 #include <gtest/gtest.h>
 
+#include <commata/encoding_error.hpp>
 #include <commata/parse_error.hpp>
 #include <commata/parse_tsv.hpp>
 
@@ -233,6 +234,22 @@ TEST_F(TestParseTsv, NoBufferControlWithBufferSizeAndAllocator)
     ASSERT_EQ(4U, allocations.front());
 }
 
+// Tests values long enough to span over several blocks of characters which
+// may be examined at once
+TEST_F(TestParseTsv, LongValues)
+{
+    const std::string a(33, 'a');
+    const std::string b(70, 'b');
+    const std::string s = a + '\t' + b + "\r\n" + b + '\t' + a;
+    for (const std::size_t buffer_size : { 1, 10, 1024 }) {
+        std::ostringstream str;
+        simple_transcriptor handler(str, true);
+        parse_tsv(std::istringstream(s), handler, buffer_size);
+        ASSERT_EQ("{(" + a + ")(" + b + ")}{(" + b + ")(" + a + ")}",
+                  std::move(str).str()) << buffer_size;
+    }
+}
+
 // Tests if a correct physical position information is added to the exception
 // thrown and "handle_exception" is correctly called
 TEST_F(TestParseTsv, Error)
@@ -255,6 +272,40 @@ TEST_F(TestParseTsv, Error)
     ASSERT_STREQ("{(ABC )}", std::move(str).str().c_str());
 }
 
+TEST_F(TestParseTsv, ErrorCodes)
+{
+    std::ostringstream str;
+    parse_failure failure(make_error_code(parse_errc::eof_in_quoted_value));
+    ASSERT_TRUE(parse_tsv(failure, "ABC\tDEF\n\"G\n",
+        simple_transcriptor<char>(str, true)));
+    ASSERT_FALSE(failure);
+    ASSERT_STREQ("{(ABC)(DEF)}{(\"G)}", std::move(str).str().c_str());
+}
+
+TEST_F(TestParseTsv, Utf8Validation)
+{
+    std::ostringstream str;
+    ASSERT_TRUE(parse_tsv(
+        make_tsv_source<tsv_utf8_validation>("\xef\xbb\xbf" "A\t\xc3\xa9\n"),
+        simple_transcriptor<char>(str)));
+    ASSERT_STREQ("<{(A)(\xc3\xa9)}>", std::move(str).str().c_str());
+
+    std::ostringstream str2;
+    try {
+        parse_tsv(make_tsv_source<tsv_utf8_validation>("A\tB\nC\xe3\x81\t"),
+            simple_transcriptor<char>(str2), 4);
+        FAIL();
+    } catch (const encoding_error& e) {
+        ASSERT_STREQ("Invalid UTF-8 sequence at byte offset 7", e.what());
+        ASSERT_TRUE(e.get_physical_position().has_value());
+        ASSERT_EQ(1U, e.get_physical_position()->first);
+        ASSERT_EQ(3U, e.get_physical_position()->second);
+    }
+    // The value which contains the invalid sequence does not reach the
+    // handler
+    ASSERT_STREQ("<{(A)(B)}><", std::move(str2).str().c_str());
+}
+
 TEST_F(TestParseTsv, SourceCopyAssign)
 {
     auto source = make_tsv_source("12\t345\t6789");
@@ -0,0 +1,185 @@
+/**
+ * These codes are licensed under the Unlicense.
+ * http://unlicense.org
+ */
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <commata/char_input.hpp>
+#include <commata/parse_csv.hpp>
+#include <commata/prefetching_input.hpp>
+
+#include "BaseTest.hpp"
+#include "piecewise_streambuf.hpp"
+#include "test_collector.hpp"
+
+using namespace std::string_view_literals;
+
+using namespace commata;
+using namespace commata::test;
+
+namespace {
+
+// Reads from a string_input and throws when more than the specified number of
+// chars are requested in total
+class throwing_input
+{
+    string_input<char> in_;
+    std::size_t rest_;
+
+public:
+    using char_type = char;
+    using traits_type = std::char_traits<char>;
+    using size_type = std::size_t;
+
+    throwing_input(std::string_view s, std::size_t n) :
+        in_(s), rest_(n)
+    {}
+
+    size_type operator()(char* out, size_type n)
+    {
+        if (n > rest_) {
+            throw std::runtime_error("Thrown");
+        }
+        const auto m = in_(out, n);
+        rest_ -= m;
+        return m;
+    }
+};
+
+} // end unnamed
+
+struct TestPrefetchingInput :
+    BaseTestWithParam<std::pair<std::size_t, std::size_t>>
+{};
+
+TEST_P(TestPrefetchingInput, Direct)
+{
+    const auto [buffer_size, buffer_count] = GetParam();
+    prefetching_input in(string_input("1234567"sv), buffer_size, buffer_count);
+    ASSERT_EQ(buffer_size, in.get_buffer_size());
+    ASSERT_EQ(buffer_count, in.get_buffer_count());
+
+    std::string read;
+    while (!in.eof()) {
+        const auto [p, length] = in(5);
+        ASSERT_LE(length, 5U);
+        ASSERT_LE(length, buffer_size);
+        read.append(p, length);
+    }
+    ASSERT_EQ("1234567", read);
+    ASSERT_EQ(0U, in(5).second);
+}
+
+TEST_P(TestPrefetchingInput, Copy)
+{
+    const auto [buffer_size, buffer_count] = GetParam();
+    prefetching_input in(string_input("1234567"sv), buffer_size, buffer_count);
+    char b[5];
+
+    ASSERT_EQ(4U, in(b, 4));    // reads 1234
+    b[4] = '\0';
+    ASSERT_STREQ("1234", b);
+    ASSERT_EQ(3U, in(b, 4));    // reads 567
+    b[3] = '\0';
+    ASSERT_STREQ("567", b);
+    ASSERT_TRUE(in.eof());
+    ASSERT_EQ(0U, in(b, 4));
+}
+
+TEST_P(TestPrefetchingInput, ParseCsv)
+{
+    const auto [buffer_size, buffer_count] = GetParam();
+    std::string s;
+    for (std::size_t i = 0; i < 1000; ++i) {
+        s += std::to_string(i);
+        s += (i % 7 == 6) ? "\n" : ",\"x\ny\",";
+    }
+
+    std::vector<std::vector<std::string>> expected;
+    ASSERT_TRUE(parse_csv(s, test_collector<char>(expected)));
+
+    std::vector<std::vector<std::string>> field_values;
+    ASSERT_TRUE(make_csv_source(
+            prefetching_input(string_input(s), buffer_size, buffer_count))
+        (test_collector<char>(field_values))());
+    ASSERT_EQ(expected, field_values);
+}
+
+TEST_P(TestPrefetchingInput, ReportsEof)
+{
+    const auto [buffer_size, buffer_count] = GetParam();
+    piecewise_streambuf<char> sb({ "A,", "B\nC", "", "\n" });
+    std::vector<std::vector<std::string>> field_values;
+    ASSERT_TRUE(make_csv_source(
+            prefetching_input(make_char_input(partial_read, sb),
+                buffer_size, buffer_count))
+        (test_collector<char>(field_values))());
+    const std::vector<std::vector<std::string>> expected = {
+        { "A", "B" }, { "C" }
+    };
+    ASSERT_EQ(expected, field_values);
+}
+
+TEST_P(TestPrefetchingInput, Throw)
+{
+    const auto [buffer_size, buffer_count] = GetParam();
+    prefetching_input in(throwing_input("1234567", 5),
+        buffer_size, buffer_count);
+    std::string read;
+    try {
+        while (!in.eof()) {
+            const auto [p, length] = in(10);
+            read.append(p, length);
+        }
+        FAIL();
+    } catch (const std::runtime_error& e) {
+        ASSERT_STREQ("Thrown", e.what());
+    }
+    // The chars read before the exception are consumed first
+    ASSERT_EQ(std::string("12345", 5 / buffer_size * buffer_size), read);
+}
+
+TEST_P(TestPrefetchingInput, Abandon)
+{
+    const auto [buffer_size, buffer_count] = GetParam();
+    const std::string s(10000, 'x');
+    prefetching_input in{string_input(s), buffer_size, buffer_count};
+    ASSERT_EQ(1U, in(1).second);
+    // The destructor stops the reading thread which is waiting for a free
+    // buffer
+}
+
+INSTANTIATE_TEST_SUITE_P(, TestPrefetchingInput,
+    testing::Values(std::make_pair(1, 2), std::make_pair(3, 2),
+                    std::make_pair(3, 5), std::make_pair(7, 2),
+                    std::make_pair(1024, 3)));
+
+struct TestPrefetchingInputMisc : BaseTest
+{};
+
+TEST_F(TestPrefetchingInputMisc, Move)
+{
+    prefetching_input in(string_input("1234567"sv), 3);
+    ASSERT_EQ(2U, in.get_buffer_count());
+    ASSERT_EQ("1"sv, std::string_view(in(1).first, 1));
+    auto in2 = std::move(in);
+    ASSERT_TRUE(in.eof());
+    ASSERT_EQ(0U, in.get_buffer_size());
+    std::string read;
+    while (!in2.eof()) {
+        const auto [p, length] = in2(10);
+        read.append(p, length);
+    }
+    ASSERT_EQ("234567", read);
+
+    prefetching_input<string_input<char>> in3;
+    ASSERT_TRUE(in3.eof());
+}
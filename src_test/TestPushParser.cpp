@@ -0,0 +1,356 @@
+/**
+ * These codes are licensed under the Unlicense.
+ * http://unlicense.org
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <commata/parse_csv.hpp>
+#include <commata/parse_tsv.hpp>
+#include <commata/push_parser.hpp>
+#include <commata/stored_table.hpp>
+
+#include "BaseTest.hpp"
+#include "test_collector.hpp"
+
+using namespace commata;
+using namespace commata::test;
+
+namespace {
+
+// Aborts on a field "ABORT"
+struct aborting_collector : test_collector<const char>
+{
+    using test_collector::test_collector;
+
+    bool finalize(const char* first, const char* last)
+    {
+        test_collector::finalize(first, last);
+        return last_record().back() != "ABORT";
+    }
+};
+
+// Collects field values turned into upper case in place
+class upper_collector
+{
+    std::vector<std::string>* field_values_;
+    std::string field_value_;
+
+public:
+    using char_type = char;
+
+    explicit upper_collector(std::vector<std::string>& field_values) :
+        field_values_(&field_values)
+    {}
+
+    void start_record(char* /*record_begin*/)
+    {}
+
+    void update(char* first, char* last)
+    {
+        std::transform(first, last, first, [](char c) {
+            return ((c >= 'a') && (c <= 'z')) ? (c - 'a' + 'A') : c;
+        });
+        field_value_.append(first, last);
+    }
+
+    void finalize(char* first, char* last)
+    {
+        update(first, last);
+        field_values_->emplace_back();
+        field_values_->back().swap(field_value_);
+    }
+
+    void end_record(char* /*record_end*/)
+    {}
+};
+
+std::string make_text(std::size_t piece_count)
+{
+    const char* const pieces[] = {
+        "a", ",", "\"", "\"\"", "b,c", "\r\n", "\n", "\r", "xyz", ",,",
+        "\n\n", "\"\n\"", "d\"\"e"
+    };
+    std::string s;
+    unsigned n = 7;
+    bool quoted = false;
+    for (std::size_t i = 0; i < piece_count; ++i) {
+        n = n * 1103515245U + 12345U;
+        std::string_view piece = pieces[(n >> 16) % std::size(pieces)];
+        if (!quoted && (piece.find('"') != std::string_view::npos)) {
+            piece = "\"";
+        }
+        if (piece == "\"") {
+            s += quoted ? "\"," : ",\"";
+            quoted = !quoted;
+        } else {
+            s += piece;
+        }
+    }
+    if (quoted) {
+        s += '"';
+    }
+    return s;
+}
+
+// Feeds s in chunks of chunk_size chars, each of which is copied to a buffer
+// that is overwritten after the feed so that the parser cannot keep any
+// reference to it
+template <class PushParser>
+bool feed_in_chunks(PushParser& parser, std::string_view s,
+    std::size_t chunk_size)
+{
+    std::string chunk;
+    for (std::size_t i = 0; i < s.size(); i += chunk_size) {
+        chunk = s.substr(i, chunk_size);
+        if (!parser.feed(chunk.data(), chunk.size())) {
+            return false;
+        }
+        std::fill(chunk.begin(), chunk.end(), '"');
+    }
+    return parser.finish();
+}
+
+} // end unnamed
+
+struct TestPushParser : BaseTestWithParam<std::size_t>
+{};
+
+TEST_P(TestPushParser, SameAsParseCsv)
+{
+    const auto s = make_text(3000);
+
+    std::vector<std::vector<std::string>> expected;
+    ASSERT_TRUE(parse_csv(s, test_collector<const char>(expected)));
+
+    std::vector<std::vector<std::string>> field_values;
+    csv_push_parser<test_collector<const char>> parser{
+        test_collector<const char>(field_values)};
+    ASSERT_TRUE(feed_in_chunks(parser, s, GetParam()));
+    ASSERT_EQ(expected, field_values);
+}
+
+TEST_P(TestPushParser, Dialect)
+{
+    const std::string s = "'A|B';C|D;'E;''F'|G";
+    std::vector<std::vector<std::string>> field_values;
+    auto parser = make_csv_push_parser<csv_dialect<';', '\'', '\r', '|'>>(
+        test_collector<const char>(field_values));
+    ASSERT_TRUE(feed_in_chunks(parser, s, GetParam()));
+    const std::vector<std::vector<std::string>> expected = {
+        { "A|B", "C" }, { "D", "E;'F" }, { "G" }
+    };
+    ASSERT_EQ(expected, field_values);
+}
+
+TEST_P(TestPushParser, SameAsParseTsv)
+{
+    std::string s = make_text(3000);
+    std::replace(s.begin(), s.end(), '"', 'q');
+    std::replace(s.begin(), s.end(), ',', '\t');
+
+    std::vector<std::vector<std::string>> expected;
+    ASSERT_TRUE(parse_tsv(s, test_collector<const char>(expected)));
+
+    std::vector<std::vector<std::string>> field_values;
+    auto parser = make_tsv_push_parser(
+        test_collector<const char>(field_values));
+    ASSERT_TRUE(feed_in_chunks(parser, s, GetParam()));
+    ASSERT_EQ(expected, field_values);
+}
+
+TEST_P(TestPushParser, Error)
+{
+    const auto s = make_text(500) + "\n\"AB\"C\nD\n";
+
+    std::pair<std::size_t, std::size_t> expected;
+    try {
+        std::vector<std::vector<std::string>> field_values;
+        parse_csv(s, test_collector<const char>(field_values));
+        FAIL();
+    } catch (const parse_error& e) {
+        ASSERT_TRUE(e.get_physical_position().has_value());
+        expected = *e.get_physical_position();
+    }
+
+    {
+        std::vector<std::vector<std::string>> field_values;
+        auto parser = make_csv_push_parser(
+            test_collector<const char>(field_values));
+        try {
+            feed_in_chunks(parser, s, GetParam());
+            FAIL();
+        } catch (const parse_error& e) {
+            ASSERT_TRUE(e.get_physical_position().has_value());
+            ASSERT_EQ(expected, *e.get_physical_position());
+        }
+        ASSERT_FALSE(parser.feed("A", 1));
+        ASSERT_FALSE(parser.finish());
+    }
+    {
+        std::vector<std::vector<std::string>> field_values;
+        auto parser = make_csv_push_parser(
+            test_collector<const char>(field_values));
+        parse_failure failure;
+        std::string chunk;
+        for (std::size_t i = 0; i < s.size(); i += GetParam()) {
+            chunk = s.substr(i, GetParam());
+            if (!parser.feed(failure, chunk.data(), chunk.size())) {
+                break;
+            }
+        }
+        ASSERT_TRUE(failure);
+        ASSERT_EQ(parse_errc::invalid_char_after_quoted_value,
+            failure.get_error_code());
+        ASSERT_EQ(expected, failure.get_physical_position());
+    }
+}
+
+TEST_P(TestPushParser, Abort)
+{
+    const std::string s = "A,B\nC,ABORT,D\nE\n";
+    std::vector<std::vector<std::string>> field_values;
+    auto parser = make_csv_push_parser(aborting_collector(field_values));
+    ASSERT_FALSE(feed_in_chunks(parser, s, GetParam()));
+    ASSERT_FALSE(parser.feed("F\n", 2));
+    ASSERT_FALSE(parser.finish());
+    const std::vector<std::vector<std::string>> expected = {
+        { "A", "B" }, { "C", "ABORT" }
+    };
+    ASSERT_EQ(expected, field_values);
+}
+
+TEST_P(TestPushParser, StoredTable)
+{
+    const auto s = make_text(3000);
+
+    stored_table expected;
+    ASSERT_TRUE(parse_csv(s, make_stored_table_builder(expected)));
+
+    // The builder keeps its values on the buffers which it hands to the
+    // parser, so the chunks, which are freed after each feed, must be
+    // copied into them
+    stored_table table;
+    auto parser = make_csv_push_parser(make_stored_table_builder(table));
+    for (std::size_t i = 0; i < s.size(); i += GetParam()) {
+        const auto size = std::min(GetParam(), s.size() - i);
+        auto chunk = std::make_unique<char[]>(size);
+        std::copy_n(s.data() + i, size, chunk.get());
+        ASSERT_TRUE(parser.feed(chunk.get(), size));
+        std::fill_n(chunk.get(), size, '"');
+    }
+    ASSERT_TRUE(parser.finish());
+    ASSERT_EQ(expected.content(), table.content());
+}
+
+INSTANTIATE_TEST_SUITE_P(,
+    TestPushParser, testing::Values(1, 2, 3, 10, 1024));
+
+struct TestPushParserEnd : BaseTest
+{};
+
+TEST_F(TestPushParserEnd, Finish)
+{
+    std::vector<std::vector<std::string>> field_values;
+    auto parser = make_csv_push_parser(
+        test_collector<const char>(field_values));
+    ASSERT_TRUE(parser.feed("A,\"B", 4));
+    ASSERT_TRUE(parser.feed(nullptr, 0));
+    ASSERT_TRUE(parser.feed("\"", 1));
+    ASSERT_EQ(1U, field_values.size());
+    ASSERT_EQ(1U, field_values.back().size());
+    ASSERT_TRUE(parser.finish());
+    const std::vector<std::vector<std::string>> expected = { { "A", "B" } };
+    ASSERT_EQ(expected, field_values);
+    ASSERT_FALSE(parser.feed("C", 1));
+    ASSERT_EQ(expected, field_values);
+}
+
+TEST_F(TestPushParserEnd, SplitBom)
+{
+    {
+        std::vector<std::vector<std::string>> field_values;
+        auto parser = make_csv_push_parser<csv_utf8_validation>(
+            test_collector<const char>(field_values));
+        ASSERT_TRUE(parser.feed("\xef\xbb", 2));
+        ASSERT_TRUE(parser.feed("\xbf" "a,b\n", 5));
+        ASSERT_TRUE(parser.finish());
+        const std::vector<std::vector<std::string>> expected =
+            { { "a", "b" } };
+        ASSERT_EQ(expected, field_values);
+    }
+    {
+        // Not the BOM but a valid sequence
+        std::vector<std::vector<std::string>> field_values;
+        auto parser = make_csv_push_parser<csv_utf8_validation>(
+            test_collector<const char>(field_values));
+        ASSERT_TRUE(parser.feed("\xef", 1));
+        ASSERT_TRUE(parser.feed("\xbb", 1));
+        ASSERT_TRUE(parser.feed("\x80,b", 3));
+        ASSERT_EQ(std::make_pair(std::size_t(0), std::size_t(5)),
+            parser.get_physical_position());
+        ASSERT_TRUE(parser.finish());
+        const std::vector<std::vector<std::string>> expected =
+            { { "\xef\xbb\x80", "b" } };
+        ASSERT_EQ(expected, field_values);
+    }
+    {
+        // Copied into the buffers of the parser
+        std::vector<std::string> field_values;
+        auto parser = make_csv_push_parser<csv_utf8_validation>(
+            upper_collector(field_values));
+        ASSERT_TRUE(parser.feed("\xef", 1));
+        ASSERT_TRUE(parser.feed("\xbb\xbf" "a,\xef\xbb\xbf", 7));
+        ASSERT_TRUE(parser.finish());
+        const std::vector<std::string> expected = { "A", "\xef\xbb\xbf" };
+        ASSERT_EQ(expected, field_values);
+    }
+}
+
+TEST_F(TestPushParserEnd, NonConstHandler)
+{
+    // The handler, which modifies the chars given, is fed with unmodifiable
+    // chunks
+    static const char s1[] = "ab,\"c";
+    static const char s2[] = "d\"\"e\"\nf";
+    std::vector<std::string> field_values;
+    auto parser = make_csv_push_parser(upper_collector(field_values));
+    ASSERT_TRUE(parser.feed(s1, sizeof s1 - 1));
+    ASSERT_TRUE(parser.feed(s2, sizeof s2 - 1));
+    ASSERT_TRUE(parser.finish());
+    const std::vector<std::string> expected = { "AB", "CD\"E", "F" };
+    ASSERT_EQ(expected, field_values);
+    ASSERT_STREQ("ab,\"c", s1);
+}
+
+TEST_F(TestPushParserEnd, StoredTableAcrossChunks)
+{
+    stored_table table;
+    auto parser = make_csv_push_parser(make_stored_table_builder(table));
+    {
+        auto chunk = std::make_unique<char[]>(8);
+        std::copy_n("abc,defg", 8, chunk.get());
+        ASSERT_TRUE(parser.feed(chunk.get(), 8));
+    }
+    {
+        auto chunk = std::make_unique<char[]>(8);
+        std::copy_n("hij\nx,y\n", 8, chunk.get());
+        ASSERT_TRUE(parser.feed(chunk.get(), 8));
+    }
+    ASSERT_TRUE(parser.finish());
+    ASSERT_EQ(2U, table.size());
+    ASSERT_EQ(2U, table[0].size());
+    ASSERT_EQ("abc", table[0][0]);
+    ASSERT_EQ("defghij", table[0][1]);
+    ASSERT_EQ("x", table[1][0]);
+    ASSERT_EQ("y", table[1][1]);
+}
@@ -0,0 +1,153 @@
+/**
+ * These codes are licensed under the Unlicense.
+ * http://unlicense.org
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <commata/parse_csv.hpp>
+#include <commata/segmented_input.hpp>
+
+#include "BaseTest.hpp"
+#include "test_collector.hpp"
+
+using namespace std::string_view_literals;
+
+using namespace commata;
+using namespace commata::test;
+
+namespace {
+
+// Collects fields and the sizes of the buffers
+class buffer_size_collector : public test_collector<const char>
+{
+    std::vector<std::size_t>* buffer_sizes_;
+
+public:
+    buffer_size_collector(std::vector<std::vector<std::string>>& field_values,
+        std::vector<std::size_t>& buffer_sizes) :
+        test_collector(field_values), buffer_sizes_(&buffer_sizes)
+    {}
+
+    void start_buffer(const char* buffer_begin, const char* buffer_end)
+    {
+        buffer_sizes_->push_back(buffer_end - buffer_begin);
+    }
+};
+
+} // end unnamed
+
+struct TestSegmentedInput : BaseTest
+{};
+
+TEST_F(TestSegmentedInput, Direct)
+{
+    const std::vector<std::string_view> segments = { "ab"sv, ""sv, "cde"sv };
+    auto in = make_segmented_input(segments.cbegin(), segments.cend());
+    static_assert(std::is_same_v<char, decltype(in)::char_type>);
+
+    auto r = in(2);
+    ASSERT_EQ(segments[0].data(), r.first);     // not copied
+    ASSERT_EQ(2U, r.second);
+    r = in(2);
+    ASSERT_EQ(segments[2].data(), r.first);
+    ASSERT_EQ(2U, r.second);
+    ASSERT_FALSE(in.eof());
+    r = in(2);
+    ASSERT_EQ(segments[2].data() + 2, r.first);
+    ASSERT_EQ(1U, r.second);
+    ASSERT_FALSE(in.eof());
+    ASSERT_EQ(0U, in(2).second);
+    ASSERT_TRUE(in.eof());
+}
+
+TEST_F(TestSegmentedInput, Copy)
+{
+    const std::vector<std::wstring> segments = { L"ab", L"cde" };
+    auto in = make_segmented_input(segments.cbegin(), segments.cend());
+    static_assert(std::is_same_v<wchar_t, decltype(in)::char_type>);
+    wchar_t b[4];
+
+    ASSERT_EQ(2U, in(b, 4));    // reads ab; segments are never joined
+    ASSERT_EQ(L"ab"sv, std::wstring_view(b, 2));
+    ASSERT_EQ(3U, in(b, 4));    // reads cde
+    ASSERT_EQ(L"cde"sv, std::wstring_view(b, 3));
+    ASSERT_EQ(0U, in(b, 4));
+    ASSERT_TRUE(in.eof());
+}
+
+TEST_F(TestSegmentedInput, Supplier)
+{
+    std::vector<std::string> frames = { "A,\"B", "\"\"C\",D", "\n" };
+    std::size_t i = 0;
+    auto supplier = [&frames, &i]() -> std::optional<std::string_view> {
+        if (i == frames.size()) {
+            return std::nullopt;
+        }
+        return frames[i++];
+    };
+
+    std::vector<std::vector<std::string>> field_values;
+    std::vector<std::size_t> buffer_sizes;
+    ASSERT_TRUE(parse_csv(segmented_input(supplier),
+        buffer_size_collector(field_values, buffer_sizes)));
+    const std::vector<std::vector<std::string>> expected = {
+        { "A", "B\"C", "D" }
+    };
+    ASSERT_EQ(expected, field_values);
+    // Each segment has become a buffer, and the end of the text has been
+    // found with an empty one
+    const std::vector<std::size_t> expected_sizes = { 4, 6, 1, 0 };
+    ASSERT_EQ(expected_sizes, buffer_sizes);
+}
+
+TEST_F(TestSegmentedInput, ParseCsv)
+{
+    std::string s;
+    for (std::size_t i = 0; i < 1000; ++i) {
+        s += std::to_string(i);
+        s += (i % 7 == 6) ? "\n" : ",\"x\ny\",";
+    }
+    std::vector<std::string_view> segments;
+    for (std::size_t i = 0; i < s.size(); i += 1 + i % 13) {
+        segments.push_back(std::string_view(s).substr(i, 1 + i % 13));
+        if (i % 5 == 0) {
+            segments.emplace_back();
+        }
+    }
+
+    std::vector<std::vector<std::string>> expected;
+    std::vector<std::size_t> buffer_sizes;
+    ASSERT_TRUE(parse_csv(s, buffer_size_collector(expected, buffer_sizes)));
+
+    std::vector<std::vector<std::string>> field_values;
+    buffer_sizes.clear();
+    ASSERT_TRUE(parse_csv(
+        make_segmented_input(segments.cbegin(), segments.cend()),
+        buffer_size_collector(field_values, buffer_sizes)));
+    ASSERT_EQ(expected, field_values);
+    // Empty segments are skipped
+    ASSERT_EQ(0U, buffer_sizes.back());
+    ASSERT_TRUE(std::find(buffer_sizes.cbegin(), buffer_sizes.cend() - 1, 0U)
+             == buffer_sizes.cend() - 1);
+}
+
+TEST_F(TestSegmentedInput, Swap)
+{
+    const std::vector<std::string_view> segments = { "ab"sv, "cd"sv };
+    auto in1 = make_segmented_input(segments.cbegin(), segments.cend());
+    auto in2 = make_segmented_input(segments.cend(), segments.cend());
+    ASSERT_EQ(1U, in1(1).second);
+    swap(in1, in2);
+    ASSERT_EQ(0U, in1(1).second);
+    ASSERT_TRUE(in1.eof());
+    ASSERT_EQ("b"sv, std::string_view(in2(2).first, 1));
+}
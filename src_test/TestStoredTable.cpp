@@ -1193,6 +1193,9 @@ using ContentLRs = testing::Types<
         std::deque<std::vector<stored_value>>>,
     std::pair<
         std::list<std::vector<stored_value>>,
+        std::deque<std::vector<stored_value>>>,
+    std::pair<
+        basic_flat_stored_content<stored_value>,
         std::deque<std::vector<stored_value>>>>;
 
 } // end unnamed
@@ -1912,6 +1915,156 @@ TEST_P(TestStoredTableBuilder, Transpose)
     ASSERT_EQ(3U, table[2].size());
 }
 
+TEST_P(TestStoredTableBuilder, Flat)
+{
+    const char* s = "Col1,Col2\n"
+                    "aaa,bbb,ccc\n"
+                    "\n"
+                    "AAA,\"B\nB\",\n";
+    flat_stored_table table(GetParam());
+    try {
+        parse_csv(s, make_stored_table_builder(table));
+    } catch (const text_error& e) {
+        FAIL() << text_error_info(e);
+    }
+
+    ASSERT_EQ(3U, table.size());
+    ASSERT_EQ(8U, table.content().value_count());
+    ASSERT_EQ(2U, table[0].size());
+    ASSERT_EQ("Col1", table[0][0]);
+    ASSERT_EQ("Col2", table[0][1]);
+    ASSERT_EQ(3U, table[1].size());
+    ASSERT_EQ("aaa", table[1][0]);
+    ASSERT_EQ("ccc", table[1][2]);
+    ASSERT_EQ(3U, table[2].size());
+    ASSERT_EQ("AAA", table[2][0]);
+    ASSERT_EQ("B\nB", table[2][1]);
+    ASSERT_EQ("", table[2][2]);
+
+    // Values of adjacent records are adjacent
+    ASSERT_EQ(table[0].end(), table[1].begin());
+    ASSERT_EQ(table[1].end(), table[2].begin());
+
+    flat_stored_table transposed(GetParam());
+    try {
+        parse_csv(s, make_stored_table_builder<
+            stored_table_builder_option::transpose>(transposed));
+    } catch (const text_error& e) {
+        FAIL() << text_error_info(e);
+    }
+
+    ASSERT_EQ(3U, transposed.size());
+    ASSERT_EQ(3U, transposed[0].size());
+    ASSERT_EQ("Col1", transposed[0][0]);
+    ASSERT_EQ("aaa", transposed[0][1]);
+    ASSERT_EQ("AAA", transposed[0][2]);
+    ASSERT_EQ(3U, transposed[1].size());
+    ASSERT_EQ("B\nB", transposed[1][2]);
+    ASSERT_EQ(3U, transposed[2].size());
+    ASSERT_EQ("", transposed[2][0]);
+    ASSERT_EQ("ccc", transposed[2][1]);
+    ASSERT_EQ("", transposed[2][2]);
+}
+
+TEST_P(TestStoredTableBuilder, Compact)
+{
+    const char* s = "Col1,Col2\n"
+                    "aaa,bbb,ccc\n"
+                    "\n"
+                    "AAA,\"B\nB\",\n";
+    compact_stored_table table(GetParam());
+    try {
+        parse_csv(s, make_stored_table_builder(table));
+    } catch (const text_error& e) {
+        FAIL() << text_error_info(e);
+    }
+
+    ASSERT_EQ(3U, table.size());
+    ASSERT_EQ(8U, table.content().value_count());
+    ASSERT_EQ(2U, table[0].size());
+    ASSERT_EQ("Col1", table[0][0]);
+    ASSERT_EQ("Col2", table[0][1]);
+    ASSERT_EQ(3U, table[1].size());
+    ASSERT_EQ("aaa", table[1][0]);
+    ASSERT_EQ("ccc", table[1][2]);
+    ASSERT_EQ(3U, table[2].size());
+    ASSERT_EQ("AAA", table[2][0]);
+    ASSERT_EQ("B\nB", table[2][1]);
+    ASSERT_EQ("", table[2][2]);
+    ASSERT_STREQ("bbb", stored_value(table[1][1]).c_str());
+
+    compact_stored_table transposed(GetParam());
+    try {
+        parse_csv(s, make_stored_table_builder<
+            stored_table_builder_option::transpose>(transposed));
+    } catch (const text_error& e) {
+        FAIL() << text_error_info(e);
+    }
+
+    ASSERT_EQ(3U, transposed.size());
+    ASSERT_EQ(3U, transposed[0].size());
+    ASSERT_EQ("Col1", transposed[0][0]);
+    ASSERT_EQ("aaa", transposed[0][1]);
+    ASSERT_EQ("AAA", transposed[0][2]);
+    ASSERT_EQ(3U, transposed[1].size());
+    ASSERT_EQ("B\nB", transposed[1][2]);
+    ASSERT_EQ(3U, transposed[2].size());
+    ASSERT_EQ("", transposed[2][0]);
+    ASSERT_EQ("ccc", transposed[2][1]);
+    ASSERT_EQ("", transposed[2][2]);
+}
+
+TEST_P(TestStoredTableBuilder, Intern)
+{
+    const char* s = "JP,JPY,\"active\"\n"
+                    "US,USD,active\n"
+                    "JP,JPY,inactive\n"
+                    "\"J\"\"P\",JP\n";
+    cstored_table table(GetParam());
+    try {
+        parse_csv(s, make_stored_table_builder<
+            stored_table_builder_option::intern>(table));
+    } catch (const text_error& e) {
+        FAIL() << text_error_info(e);
+    }
+
+    ASSERT_EQ(4U, table.size());
+    ASSERT_EQ("JP", table[0][0]);
+    ASSERT_EQ("JPY", table[0][1]);
+    ASSERT_EQ("active", table[0][2]);
+    ASSERT_EQ("US", table[1][0]);
+    ASSERT_EQ("active", table[1][2]);
+    ASSERT_EQ("inactive", table[2][2]);
+    ASSERT_EQ("J\"P", table[3][0]);
+    ASSERT_EQ("JP", table[3][1]);
+
+    // Equal values share their characters, even across fields
+    ASSERT_EQ(table[0][0].c_str(), table[2][0].c_str());
+    ASSERT_EQ(table[0][0].c_str(), table[3][1].c_str());
+    ASSERT_EQ(table[0][1].c_str(), table[2][1].c_str());
+    ASSERT_EQ(table[0][2].c_str(), table[1][2].c_str());
+    ASSERT_NE(table[0][2].c_str(), table[2][2].c_str());
+
+    cstored_table transposed(GetParam());
+    try {
+        parse_csv(s, make_stored_table_builder<
+            stored_table_builder_option::transpose
+          | stored_table_builder_option::intern>(transposed));
+    } catch (const text_error& e) {
+        FAIL() << text_error_info(e);
+    }
+
+    ASSERT_EQ(3U, transposed.size());
+    ASSERT_EQ("JP", transposed[1][3]);
+    ASSERT_EQ(transposed[0][0].c_str(), transposed[1][3].c_str());
+    ASSERT_EQ(3U, transposed[2].size());
+
+    // The copy of an interned table has its own canonical values
+    const cstored_table copied(table);
+    ASSERT_EQ(copied[0][0].c_str(), copied[2][0].c_str());
+    ASSERT_NE(table[0][0].c_str(), copied[0][0].c_str());
+}
+
 TEST_P(TestStoredTableBuilder, Fancy)
 {
     using content_t = std::vector<std::vector<wstored_value>>;
@@ -1938,6 +2091,200 @@ TEST_P(TestStoredTableBuilder, Fancy)
 INSTANTIATE_TEST_SUITE_P(,
     TestStoredTableBuilder, testing::Values(2, 11, 1024));
 
+struct TestFlatStoredTable : BaseTest
+{};
+
+TEST_F(TestFlatStoredTable, Records)
+{
+    flat_stored_table table;
+    auto& c = table.content();
+    c.emplace_back().resize(2);
+    c.emplace_back();
+    c.emplace_back(1U, stored_value());
+    table.rewrite_value(table[0][0], "alpha");
+    table.rewrite_value(table[0][1], "beta");
+    table.rewrite_value(table[2][0], "delta");
+
+    // Growing a record in the middle shifts the following records
+    table[1].push_back(table.import_value("gamma"));
+    ASSERT_EQ(3U, table.size());
+    ASSERT_EQ(4U, c.value_count());
+    ASSERT_EQ(1U, table[1].size());
+    ASSERT_EQ("gamma", table[1][0]);
+    ASSERT_EQ("delta", table[2].front());
+
+    // Inserting a record in the middle
+    const std::vector<stored_value> r = { table.import_value("epsilon") };
+    c.emplace(std::next(c.cbegin()), r.cbegin(), r.cend());
+    ASSERT_EQ(4U, table.size());
+    ASSERT_EQ("beta", table[0].back());
+    ASSERT_EQ("epsilon", table[1][0]);
+    ASSERT_EQ("gamma", table[2][0]);
+    ASSERT_EQ("delta", table[3][0]);
+
+    // Erasing values and records
+    table[0].erase(table[0].cbegin());
+    ASSERT_EQ(1U, table[0].size());
+    ASSERT_EQ("beta", table[0][0]);
+    c.erase(std::next(c.cbegin()), std::next(c.cbegin(), 3));
+    ASSERT_EQ(2U, table.size());
+    ASSERT_EQ(2U, c.value_count());
+    ASSERT_EQ("beta", table[0][0]);
+    ASSERT_EQ("delta", table[1][0]);
+
+    std::vector<std::string> all;
+    for (auto rec : c) {
+        for (const auto& v : rec) {
+            all.emplace_back(v.cbegin(), v.cend());
+        }
+    }
+    ASSERT_EQ((std::vector<std::string>{ "beta", "delta" }), all);
+
+    c.pop_back();
+    ASSERT_EQ(1U, table.size());
+    ASSERT_EQ(1U, c.value_count());
+}
+
+TEST_F(TestFlatStoredTable, CopyAndAppend)
+{
+    flat_stored_table table1;
+    table1.content().emplace_back().resize(2);
+    table1.rewrite_value(table1[0][0], "sky");
+    table1.rewrite_value(table1[0][1], "sea");
+    table1.content().emplace_back(1U, table1.import_value("land"));
+
+    flat_stored_table table2(table1);
+    ASSERT_EQ(2U, table2.size());
+    ASSERT_EQ("sea", table2[0][1]);
+    ASSERT_EQ("land", table2[1][0]);
+    ASSERT_NE(table1[1][0].cbegin(), table2[1][0].cbegin());
+
+    stored_table table3;
+    table3 += table1;
+    ASSERT_EQ(2U, table3.size());
+    ASSERT_EQ("land", table3[1][0]);
+
+    table2 += std::move(table3);
+    ASSERT_EQ(4U, table2.size());
+    ASSERT_EQ(6U, table2.content().value_count());
+    ASSERT_EQ("sky", table2[2][0]);
+
+    const auto land = table1[1][0].cbegin();
+    table2 += std::move(table1);
+    ASSERT_EQ(6U, table2.size());
+    ASSERT_EQ("land", table2[5][0]);
+    ASSERT_EQ(land, table2[5][0].cbegin());
+}
+
+static_assert(std::is_same_v<
+    compact_stored_table::record_type::reference,
+    basic_compact_stored_content<stored_value>::value_reference>);
+
+struct TestCompactStoredTable : BaseTest
+{};
+
+TEST_F(TestCompactStoredTable, Records)
+{
+    compact_stored_table table;
+    auto& c = table.content();
+    c.emplace_back().resize(2);
+    c.emplace_back();
+    c.emplace_back(1U, stored_value());
+    ASSERT_EQ("", table[0][0]);
+    table.rewrite_value(table[0][0], "alpha");
+    table.rewrite_value(table[0][1], "beta");
+    const auto delta = table.rewrite_value(table[2][0], "delta");
+    ASSERT_EQ("delta", delta);
+    ASSERT_EQ(delta.c_str(), stored_value(table[2][0]).c_str());
+
+    // Values are written through proxies
+    table[1].push_back(table.import_value("gamma"));
+    ASSERT_EQ(3U, table.size());
+    ASSERT_EQ(4U, c.value_count());
+    ASSERT_EQ("gamma", table[1][0]);
+    ASSERT_EQ("delta", table[2].front());
+    table[2][0] = table[0][1];
+    ASSERT_EQ("beta", table[2][0]);
+    ASSERT_TRUE(table[0][1] == table[2][0]);
+    table[2][0] = delta;
+
+    // Inserting a record in the middle
+    const std::vector<stored_value> r = { table.import_value("epsilon") };
+    c.emplace(std::next(c.cbegin()), r.cbegin(), r.cend());
+    ASSERT_EQ(4U, table.size());
+    ASSERT_EQ("beta", table[0].back());
+    ASSERT_EQ("epsilon", table[1][0]);
+    ASSERT_EQ("gamma", table[2][0]);
+    ASSERT_EQ("delta", table[3][0]);
+
+    // Erasing values and records
+    table[0].erase(table[0].cbegin());
+    ASSERT_EQ(1U, table[0].size());
+    ASSERT_EQ("beta", table[0][0]);
+    c.erase(std::next(c.cbegin()), std::next(c.cbegin(), 3));
+    ASSERT_EQ(2U, table.size());
+    ASSERT_EQ(2U, c.value_count());
+
+    std::vector<std::string> all;
+    for (const auto rec : std::as_const(c)) {
+        for (const auto& v : rec) {
+            all.emplace_back(v.cbegin(), v.cend());
+        }
+    }
+    ASSERT_EQ((std::vector<std::string>{ "beta", "delta" }), all);
+
+    std::ostringstream stream;
+    stream << table[1][0];
+    ASSERT_EQ("delta", std::move(stream).str());
+}
+
+TEST_F(TestCompactStoredTable, CopyAndAppend)
+{
+    compact_stored_table table1;
+    table1.content().emplace_back().resize(2);
+    table1.rewrite_value(table1[0][0], "sky");
+    table1.rewrite_value(table1[0][1], "sea");
+    table1.content().emplace_back(1U, table1.import_value("land"));
+
+    compact_stored_table table2(table1);
+    ASSERT_EQ(2U, table2.size());
+    ASSERT_EQ("sea", table2[0][1]);
+    ASSERT_EQ("land", table2[1][0]);
+    ASSERT_NE(stored_value(table1[1][0]).cbegin(),
+              stored_value(table2[1][0]).cbegin());
+
+    stored_table table3;
+    table3 += table1;
+    ASSERT_EQ(2U, table3.size());
+    ASSERT_EQ("land", table3[1][0]);
+
+    table2 += std::move(table3);
+    ASSERT_EQ(4U, table2.size());
+    ASSERT_EQ(6U, table2.content().value_count());
+    ASSERT_EQ("sky", table2[2][0]);
+
+    const auto land = stored_value(table1[1][0]).cbegin();
+    table2 += std::move(table1);
+    ASSERT_EQ(6U, table2.size());
+    ASSERT_EQ("land", table2[5][0]);
+    ASSERT_EQ(land, stored_value(table2[5][0]).cbegin());
+}
+
+TEST_F(TestCompactStoredTable, TooLongValue)
+{
+    compact_stored_table table;
+    const std::string s(
+        compact_stored_table::content_type::max_value_size + 1, 'x');
+    auto v = table.import_value(s);
+    auto& c = table.content();
+    c.emplace_back();
+    ASSERT_THROW(c.back().push_back(v), std::length_error);
+    ASSERT_TRUE(c.back().empty());
+    c.back().push_back(table.resize_value(v, s.size() - 1));
+    ASSERT_EQ(compact_stored_table::content_type::max_value_size,
+              table[0][0].get().size());
+}
+
 struct TestStoredTableBuilderReusingBuffer : BaseTest
 {};
 
@@ -0,0 +1,182 @@
+/**
+ * These codes are licensed under the Unlicense.
+ * http://unlicense.org
+ */
+
+#ifdef _MSC_VER
+#pragma warning(disable:4996)
+#endif
+
+#include <cstddef>
+#include <deque>
+#include <list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <commata/parse_csv.hpp>
+#include <commata/stored_table_index.hpp>
+
+#include "BaseTest.hpp"
+
+using namespace commata;
+using namespace commata::test;
+
+namespace {
+
+template <class Index>
+std::vector<std::size_t> records_of(const Index& index,
+                                    typename Index::key_type key)
+{
+    const auto r = index.equal_range(key);
+    return std::vector<std::size_t>(r.first, r.second);
+}
+
+}
+
+struct TestStoredTableIndex : BaseTestWithParam<std::size_t>
+{};
+
+TEST_P(TestStoredTableIndex, Basics)
+{
+    const char* s = "id,country,status\n"
+                    "1,JP,active\n"
+                    "2,US\n"
+                    "3,JP,inactive\n"
+                    "4,\"J\"\"P\",active\n"
+                    "5,JP,active\n";
+    stored_table table(GetParam());
+    try {
+        parse_csv(s, make_stored_table_builder(table));
+    } catch (const text_error& e) {
+        FAIL() << text_error_info(e);
+    }
+
+    const auto index = make_stored_table_index(table, 1);
+    ASSERT_EQ(&table, &index.table());
+    ASSERT_EQ(1U, index.column());
+    ASSERT_EQ(6U, index.record_count());
+    ASSERT_EQ(6U, index.size());
+    ASSERT_EQ(4U, index.key_count());
+
+    // Keys of heterogeneous types
+    ASSERT_EQ((std::vector<std::size_t>{ 1, 3, 5 }), records_of(index, "JP"));
+    ASSERT_EQ(1U, index.find(std::string("JP")));
+    ASSERT_EQ(3U, index.count(table[5][1]));
+    ASSERT_EQ(2U, index.find(std::string_view("USA", 2)));
+    ASSERT_EQ(4U, index.find("J\"P"));
+    ASSERT_EQ(0U, index.find("country"));
+    ASSERT_TRUE(index.contains("US"));
+    ASSERT_FALSE(index.contains("UK"));
+    ASSERT_EQ(index.npos, index.find("UK"));
+    ASSERT_EQ(0U, index.count(""));
+
+    // Records which lack the column are not indexed
+    const auto status = make_stored_table_index(table, 2);
+    ASSERT_EQ(6U, status.record_count());
+    ASSERT_EQ(5U, status.size());
+    ASSERT_EQ((std::vector<std::size_t>{ 1, 4, 5 }),
+              records_of(status, "active"));
+    ASSERT_EQ(0U, status.count(""));
+    const auto none = make_stored_table_index(table, 3);
+    ASSERT_TRUE(none.empty());
+    ASSERT_EQ(0U, none.key_count());
+    ASSERT_FALSE(none.contains(""));
+}
+
+TEST_P(TestStoredTableIndex, Incremental)
+{
+    const char* s1 = "A,x\n"
+                     "B,y\n";
+    const char* s2 = "A,z\n"
+                     "C\n"
+                     "B,w\n";
+    cstored_table table(GetParam());
+    auto index = make_stored_table_index(table, 0);
+    ASSERT_TRUE(index.empty());
+
+    // The index catches up with each record appended by the builder
+    try {
+        parse_csv(s1, make_stored_table_builder(table,
+            [&index](auto& t) {
+                index.update();
+                EXPECT_EQ(t.size(), index.record_count());
+            }));
+        parse_csv(s2, make_stored_table_builder<
+            stored_table_builder_option::intern>(table,
+            [&index](auto&) {
+                index.update();
+            }));
+    } catch (const text_error& e) {
+        FAIL() << text_error_info(e);
+    }
+
+    ASSERT_EQ(5U, index.record_count());
+    ASSERT_EQ(3U, index.key_count());
+    ASSERT_EQ((std::vector<std::size_t>{ 0, 2 }), records_of(index, "A"));
+    ASSERT_EQ((std::vector<std::size_t>{ 1, 4 }), records_of(index, "B"));
+    ASSERT_EQ(3U, index.find("C"));
+
+    // After the table is modified, the index shall be rebuilt
+    table.content().erase(table.content().cbegin());
+    index.rebuild();
+    ASSERT_EQ(4U, index.record_count());
+    ASSERT_EQ((std::vector<std::size_t>{ 1 }), records_of(index, "A"));
+    ASSERT_EQ((std::vector<std::size_t>{ 0, 3 }), records_of(index, "B"));
+}
+
+TEST_P(TestStoredTableIndex, ManyKeys)
+{
+    std::string s;
+    for (std::size_t i = 0; i < 3000; ++i) {
+        s += std::to_string(i % 1000);
+        s += ',';
+        s += std::to_string(i);
+        s += '\n';
+    }
+    stored_table table(GetParam());
+    try {
+        parse_csv(s, make_stored_table_builder(table));
+    } catch (const text_error& e) {
+        FAIL() << text_error_info(e);
+    }
+
+    const auto by_key = make_stored_table_index(table, 0);
+    const auto by_id = make_stored_table_index(table, 1);
+    ASSERT_EQ(1000U, by_key.key_count());
+    ASSERT_EQ(3000U, by_id.key_count());
+    for (std::size_t i = 0; i < 1000; ++i) {
+        const auto k = std::to_string(i);
+        ASSERT_EQ((std::vector<std::size_t>{ i, i + 1000, i + 2000 }),
+                  records_of(by_key, k)) << i;
+        ASSERT_EQ(i + 2000, by_id.find(std::to_string(i + 2000))) << i;
+    }
+    ASSERT_FALSE(by_key.contains("1000"));
+}
+
+TEST_P(TestStoredTableIndex, OtherContents)
+{
+    const char* s = "a,1\n"
+                    "b,2\n"
+                    "a,3\n";
+    basic_stored_table<std::list<std::vector<stored_value>>>
+        listed(GetParam());
+    compact_stored_table compact(GetParam());
+    try {
+        parse_csv(s, make_stored_table_builder(listed));
+        parse_csv(s, make_stored_table_builder(compact));
+    } catch (const text_error& e) {
+        FAIL() << text_error_info(e);
+    }
+
+    const auto index1 = make_stored_table_index(listed, 0);
+    ASSERT_EQ((std::vector<std::size_t>{ 0, 2 }), records_of(index1, "a"));
+    const auto index2 = make_stored_table_index(compact, 0);
+    ASSERT_EQ((std::vector<std::size_t>{ 0, 2 }), records_of(index2, "a"));
+    ASSERT_EQ(1U, index2.find("b"));
+}
+
+INSTANTIATE_TEST_SUITE_P(,
+    TestStoredTableIndex, testing::Values(2, 11, 1024));
@@ -3,6 +3,8 @@
  * http://unlicense.org
  */
 
+#include <algorithm>
+#include <cstddef>
 #include <string>
 #include <vector>
 #include <utility>
@@ -98,6 +100,62 @@ auto transcript_primitive(PrimitiveTablePull&& pull,
     return s;
 }
 
+// Pulls all events with the specified batch size and records their states
+// and data, but not their physical positions, which depend on batch sizes
+template <class Ch>
+auto pull_events(std::basic_string<Ch> csv, std::size_t buffer_size,
+    std::size_t batch_size)
+{
+    primitive_table_pull pull(make_csv_source(csv), buffer_size);
+    pull.set_batch_size(batch_size);
+    EXPECT_EQ(std::max<std::size_t>(batch_size, 1), pull.get_batch_size());
+    std::vector<std::pair<primitive_table_pull_state, std::basic_string<Ch>>>
+        events;
+    while (pull()) {
+        std::basic_string<Ch> data;
+        switch (pull.state()) {
+        case primitive_table_pull_state::update:
+        case primitive_table_pull_state::finalize:
+            data.assign(pull[0], pull[1]);
+            break;
+        default:
+            break;
+        }
+        events.emplace_back(pull.state(), std::move(data));
+    }
+    return events;
+}
+
+// Pulls fields with table_pull, skipping some of them and some records;
+// csv is taken by value because table_pull may rewrite it
+template <class Ch>
+auto pull_fields(std::basic_string<Ch> csv, std::size_t buffer_size,
+    std::size_t batch_size)
+{
+    auto pull = make_table_pull(make_csv_source(csv), buffer_size);
+    pull.set_batch_size(batch_size);
+    std::vector<std::basic_string<Ch>> fields;
+    for (std::size_t k = 0; pull; ++k) {
+        switch (k % 5) {
+        case 1:
+            pull(2);
+            break;
+        case 3:
+            pull.skip_record();
+            break;
+        default:
+            pull();
+            break;
+        }
+        if (pull.state() == table_pull_state::field) {
+            fields.emplace_back(*pull);
+        } else if (pull.state() == table_pull_state::record_end) {
+            fields.emplace_back(1, Ch('|'));
+        }
+    }
+    return fields;
+}
+
 } // end unnamed
 
 template <class ChB>
@@ -609,9 +667,34 @@ TYPED_TEST_P(TestTablePull, ParsePoint)
     ASSERT_EQ(str.size(), pull.get_parse_point() + 2/*LF+LF*/);
 }
 
+TYPED_TEST_P(TestTablePull, Batched)
+{
+    using char_t = typename TypeParam::first_type;
+
+    const auto str = char_helper<char_t>::str;
+
+    std::basic_string<char_t> csv;
+    for (int i = 0; i < 20; ++i) {
+        csv += str("ab,\"c\nd\",\"e\"\"f\",,ghi\r\n\n\"\",j\n");
+    }
+    const auto buffer_size = TypeParam::second_type::value;
+
+    const auto expected_events = pull_events(csv, buffer_size, 1);
+    const auto expected_fields = pull_fields(csv, buffer_size, 1);
+    for (const std::size_t batch_size : {
+            std::size_t(0), std::size_t(2), std::size_t(7),
+            static_cast<std::size_t>(-1) }) {
+        ASSERT_EQ(expected_events, pull_events(csv, buffer_size, batch_size))
+            << batch_size;
+        ASSERT_EQ(expected_fields, pull_fields(csv, buffer_size, batch_size))
+            << batch_size;
+    }
+}
+
 REGISTER_TYPED_TEST_SUITE_P(TestTablePull,
     PrimitiveBasicsOnCsv, PrimitiveBasicsOnTsv,
     PrimitiveMove, PrimitiveEvadeCopying, PrimitiveEvadeCopyingNonconst,
+    Batched,
     Basics, SkipRecord, SkipField, Error, EvadeCopying, EvadeCopyingNonconst,
     Move, ToArithmetic, ParsePoint);
 
@@ -0,0 +1,339 @@
+/**
+ * These codes are licensed under the Unlicense.
+ * http://unlicense.org
+ */
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <commata/char_input.hpp>
+#include <commata/parse_csv.hpp>
+#include <commata/transcoding_input.hpp>
+
+#include "BaseTest.hpp"
+#include "piecewise_streambuf.hpp"
+#include "test_collector.hpp"
+
+using namespace std::string_view_literals;
+
+using namespace commata;
+using namespace commata::test;
+
+namespace {
+
+// Makes a wide string of code points, which are encoded in UTF-16 if
+// wchar_t is two bytes long
+std::wstring wide(std::u32string_view s)
+{
+    std::wstring w;
+    for (const auto c : s) {
+        if ((sizeof(wchar_t) == 2) && (c >= 0x10000)) {
+            w.push_back(
+                static_cast<wchar_t>(0xD800 + ((c - 0x10000) >> 10)));
+            w.push_back(
+                static_cast<wchar_t>(0xDC00 + ((c - 0x10000) & 0x3FF)));
+        } else {
+            w.push_back(static_cast<wchar_t>(c));
+        }
+    }
+    return w;
+}
+
+std::string utf8(std::u32string_view s)
+{
+    std::string bytes;
+    for (const auto c : s) {
+        if (c < 0x80) {
+            bytes.push_back(static_cast<char>(c));
+        } else if (c < 0x800) {
+            bytes.push_back(static_cast<char>(0xC0 | (c >> 6)));
+            bytes.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+        } else if (c < 0x10000) {
+            bytes.push_back(static_cast<char>(0xE0 | (c >> 12)));
+            bytes.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+            bytes.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+        } else {
+            bytes.push_back(static_cast<char>(0xF0 | (c >> 18)));
+            bytes.push_back(static_cast<char>(0x80 | ((c >> 12) & 0x3F)));
+            bytes.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+            bytes.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+        }
+    }
+    return bytes;
+}
+
+std::u16string to_utf16(std::u32string_view s)
+{
+    std::u16string s16;
+    for (const auto c : s) {
+        if (c >= 0x10000) {
+            s16.push_back(
+                static_cast<char16_t>(0xD800 + ((c - 0x10000) >> 10)));
+            s16.push_back(
+                static_cast<char16_t>(0xDC00 + ((c - 0x10000) & 0x3FF)));
+        } else {
+            s16.push_back(static_cast<char16_t>(c));
+        }
+    }
+    return s16;
+}
+
+std::string utf16(std::u16string_view s, bool big_endian)
+{
+    std::string bytes;
+    for (const auto u : s) {
+        const auto hi = static_cast<char>(u >> 8);
+        const auto lo = static_cast<char>(u & 0xFF);
+        bytes.push_back(big_endian ? hi : lo);
+        bytes.push_back(big_endian ? lo : hi);
+    }
+    return bytes;
+}
+
+template <class Input>
+std::basic_string<typename Input::char_type> read_all(
+    Input& in, std::size_t n)
+{
+    std::basic_string<typename Input::char_type> read;
+    std::vector<typename Input::char_type> b(n);
+    for (;;) {
+        const auto length = in(b.data(), n);
+        read.append(b.data(), length);
+        if (length < n) {
+            break;
+        }
+    }
+    return read;
+}
+
+// Long ASCII runs make the vectorized paths work
+std::u32string make_text()
+{
+    std::u32string s;
+    for (int i = 0; i < 200; ++i) {
+        s += U"abcdefghijklmnopqrstuvwxyz,0123456789\n";
+        s += U"\u00e9t\u00e9,\u65e5\u672c\u8a9e,\U0001F600\n";
+    }
+    return s;
+}
+
+} // end unnamed
+
+struct TestTranscodingInput :
+    BaseTestWithParam<std::pair<std::size_t, std::size_t>>
+{};
+
+TEST_P(TestTranscodingInput, Utf8)
+{
+    const auto [buffer_size, read_size] = GetParam();
+    const auto s = make_text();
+    const auto bytes = utf8(s);
+
+    transcoding_input<string_input<char>, utf8_encoding> in{
+        string_input(bytes), invalid_sequence::error, 0xFFFD, buffer_size};
+    ASSERT_EQ(wide(s), read_all(in, read_size));
+}
+
+TEST_P(TestTranscodingInput, Utf16)
+{
+    const auto [buffer_size, read_size] = GetParam();
+    const auto s = make_text();
+    const auto w = wide(s);
+    const auto s16 = to_utf16(s);
+
+    const auto le = utf16(s16, false);
+    transcoding_input<string_input<char>, utf16le_encoding> in_le{
+        string_input(le), invalid_sequence::error, 0xFFFD, buffer_size};
+    ASSERT_EQ(w, read_all(in_le, read_size));
+
+    const auto be = utf16(s16, true);
+    transcoding_input<string_input<char>, utf16be_encoding> in_be{
+        string_input(be), invalid_sequence::error, 0xFFFD, buffer_size};
+    ASSERT_EQ(w, read_all(in_be, read_size));
+}
+
+TEST_P(TestTranscodingInput, Utf8Invalid)
+{
+    const auto [buffer_size, read_size] = GetParam();
+    // Invalid sequences are replaced as maximal subparts: the lone
+    // continuation byte, the truncated three-byte sequence, the overlong
+    // two-byte sequence (each byte), the surrogate (each byte) and the
+    // truncated sequence at the end
+    const auto bytes =
+        "a\x80" "b\xe6\x97" "c\xc0\xaf" "d\xed\xa0\x80" "e\xf0\x9f\x98"sv;
+    const auto expected = wide(U"a\uFFFDb\uFFFDc\uFFFD\uFFFDd"
+                               U"\uFFFD\uFFFD\uFFFDe\uFFFD");
+
+    transcoding_input<string_input<char>, utf8_encoding> in{
+        string_input(bytes), invalid_sequence::replace, 0xFFFD, buffer_size};
+    ASSERT_EQ(expected, read_all(in, read_size));
+
+    transcoding_input<string_input<char>, utf8_encoding> in2{
+        string_input(bytes), invalid_sequence::replace, U'?', buffer_size};
+    ASSERT_EQ(L"a?b?c??d???e?", read_all(in2, read_size));
+
+    transcoding_input<string_input<char>, utf8_encoding> in3{
+        string_input(bytes), invalid_sequence::skip, 0xFFFD, buffer_size};
+    ASSERT_EQ(L"abcde", read_all(in3, read_size));
+
+    transcoding_input<string_input<char>, utf8_encoding> in4{
+        string_input(bytes), invalid_sequence::error, 0xFFFD, buffer_size};
+    try {
+        read_all(in4, read_size);
+        FAIL();
+    } catch (const encoding_error& e) {
+        ASSERT_STREQ("Invalid UTF-8 sequence at byte offset 1", e.what());
+    }
+}
+
+TEST_P(TestTranscodingInput, Utf16Invalid)
+{
+    const auto [buffer_size, read_size] = GetParam();
+    // A lone low surrogate, a lone high surrogate and an odd byte at the end
+    const auto bytes = utf16(u"a\xDC00" "b\xD800" "c", false) + 'x';
+    transcoding_input<string_input<char>, utf16le_encoding> in{
+        string_input(bytes), invalid_sequence::replace, U'?', buffer_size};
+    ASSERT_EQ(L"a?b?c?", read_all(in, read_size));
+}
+
+TEST_P(TestTranscodingInput, Latin1)
+{
+    const auto [buffer_size, read_size] = GetParam();
+    std::string bytes;
+    std::wstring expected;
+    for (int i = 0; i < 3; ++i) {
+        for (int c = 1; c < 0x100; ++c) {
+            bytes.push_back(static_cast<char>(c));
+            expected.push_back(static_cast<wchar_t>(c));
+        }
+    }
+    transcoding_input<string_input<char>, latin1_encoding> in{
+        string_input(bytes), invalid_sequence::error, 0xFFFD, buffer_size};
+    ASSERT_EQ(expected, read_all(in, read_size));
+}
+
+TEST_P(TestTranscodingInput, Cp932)
+{
+    const auto [buffer_size, read_size] = GetParam();
+    // Hiragana, halfwidth katakana, kanji and katakana whose trail bytes are
+    // 0x5C and 0x7C, NEC special and IBM extended chars, and the single bytes
+    // which Microsoft maps to U+0080 and the private use area
+    const auto bytes = "\x82\xa0\x82\xa2,\xb1\xb2\n\x95\x5c\x94\x5c"
+                       "\x83\x7c\x87\x40\xfa\x40\x80\xa0\xfd\xfe\xff"sv;
+    const auto expected = wide(U"\u3042\u3044,\uFF71\uFF72\n\u8868\u80FD"
+                               U"\u30DD\u2460\u2170\u0080"
+                               U"\uF8F0\uF8F1\uF8F2\uF8F3");
+    transcoding_input<string_input<char>, cp932_encoding> in{
+        string_input(bytes), invalid_sequence::error, 0xFFFD, buffer_size};
+    ASSERT_EQ(expected, read_all(in, read_size));
+}
+
+TEST_P(TestTranscodingInput, Cp932Invalid)
+{
+    const auto [buffer_size, read_size] = GetParam();
+    // A lead byte followed by a non-trail byte, an unmapped pair with a
+    // non-ASCII trail byte, an unmapped pair with an ASCII trail byte and a
+    // lead byte at the end; ASCII chars after the lead bytes survive
+    const auto bytes = "a\x81\"b\x85\xa0" "c\x85\x40" "d\x82"sv;
+    transcoding_input<string_input<char>, cp932_encoding> in{
+        string_input(bytes), invalid_sequence::replace, U'?', buffer_size};
+    ASSERT_EQ(L"a?\"b?c?@d?", read_all(in, read_size));
+
+    transcoding_input<string_input<char>, cp932_encoding> in2{
+        string_input(bytes), invalid_sequence::error, 0xFFFD, buffer_size};
+    try {
+        read_all(in2, read_size);
+        FAIL();
+    } catch (const encoding_error& e) {
+        ASSERT_STREQ("Invalid CP932 sequence at byte offset 1", e.what());
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(, TestTranscodingInput,
+    testing::Values(std::make_pair(4, 1), std::make_pair(5, 3),
+                    std::make_pair(7, 64), std::make_pair(64, 17),
+                    std::make_pair(0, 1024)));
+
+struct TestTranscodingInputMisc : BaseTest
+{};
+
+TEST_F(TestTranscodingInputMisc, ToChar)
+{
+    // Conversions to char validate UTF-8 texts or convert UTF-16 ones to them
+    const auto bytes = "\xe6\x97\xa5\xe6\x9c\xac,\xff\n"sv;
+    transcoding_input<string_input<char>, utf8_encoding, char> in{
+        string_input(bytes)};
+    ASSERT_EQ("\xe6\x97\xa5\xe6\x9c\xac,\xef\xbf\xbd\n", read_all(in, 4));
+
+    const auto bytes16 = utf16(u"\u65e5\U0001F600", true);
+    transcoding_input<string_input<char>, utf16be_encoding, char> in16{
+        string_input(bytes16)};
+    ASSERT_EQ("\xe6\x97\xa5\xf0\x9f\x98\x80", read_all(in16, 3));
+}
+
+TEST_F(TestTranscodingInputMisc, PartialRead)
+{
+    piecewise_streambuf<char> sb(
+        { "\xe6", "", "\x97\xa5,\xf0\x9f", "\x98\x80" });
+    transcoding_input<partial_read_input<std::streambuf>, utf8_encoding> in{
+        make_char_input(partial_read, sb)};
+    ASSERT_EQ(wide(U"\u65e5,\U0001F600"), read_all(in, 10));
+}
+
+TEST_F(TestTranscodingInputMisc, ParseCsv)
+{
+    const auto bytes = "\xe5\x90\x8d\xe5\x89\x8d,\"\xe5\x80\xa4\n\"\n"
+                       "\xc3\xa9t\xc3\xa9,1\n"sv;
+    std::vector<std::vector<std::wstring>> field_values;
+    ASSERT_TRUE(parse_csv(
+        transcoding_input<string_input<char>, utf8_encoding>(
+            string_input(bytes)),
+        test_collector<wchar_t>(field_values)));
+    const std::vector<std::vector<std::wstring>> expected = {
+        { wide(U"\u540d\u524d"), wide(U"\u5024\n") },
+        { L"\u00e9t\u00e9", L"1" }
+    };
+    ASSERT_EQ(expected, field_values);
+}
+
+TEST_F(TestTranscodingInputMisc, ParseCsvCp932)
+{
+    // Trail bytes of 0x5C and 0x7C, which are not backslashes or vertical
+    // bars there, and a broken lead byte just before a closing DQUOTE
+    const auto bytes =
+        "\"\x95\x5c,\x83\x7c\t\",\"\x81\"\r\n"
+        "\x83\x5c\x83\x74\x83\x67,\xba\xdd\xcb\xdf\xad\xb0\xc0\r\n"sv;
+    std::vector<std::vector<std::wstring>> field_values;
+    ASSERT_TRUE(parse_csv(
+        transcoding_input<string_input<char>, cp932_encoding>(
+            string_input(bytes)),
+        test_collector<wchar_t>(field_values)));
+    const std::vector<std::vector<std::wstring>> expected = {
+        { wide(U"\u8868,\u30DD\t"), wide(U"\uFFFD") },
+        { wide(U"\u30BD\u30D5\u30C8"),
+          wide(U"\uFF7A\uFF9D\uFF8B\uFF9F\uFF6D\uFF70\uFF80") }
+    };
+    ASSERT_EQ(expected, field_values);
+}
+
+TEST_F(TestTranscodingInputMisc, ParseCsvError)
+{
+    const auto bytes = "a,b\nc,\xff\n"sv;
+    std::vector<std::vector<std::wstring>> field_values;
+    try {
+        parse_csv(
+            transcoding_input<string_input<char>, utf8_encoding>(
+                string_input(bytes), invalid_sequence::error),
+            test_collector<wchar_t>(field_values));
+        FAIL();
+    } catch (const encoding_error& e) {
+        ASSERT_NE(nullptr, std::strstr(e.what(), "offset 6"));
+        ASSERT_TRUE(e.get_physical_position());
+    }
+}
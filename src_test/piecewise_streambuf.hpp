@@ -0,0 +1,64 @@
+/**
+ * These codes are licensed under the Unlicense.
+ * http://unlicense.org
+ */
+
+#ifndef COMMATA_GUARD_7692C1A3_AB35_4E61_B2FB_236C8AF64643
+#define COMMATA_GUARD_7692C1A3_AB35_4E61_B2FB_236C8AF64643
+
+#include <cstddef>
+#include <functional>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace commata::test {
+
+// Makes its pieces available one by one like a pipe or a socket does; the
+// i-th piece arrives only when it is demanded, and then on_arrival(i) is
+// called
+template <class Ch, class Tr = std::char_traits<Ch>>
+class piecewise_streambuf : public std::basic_streambuf<Ch, Tr>
+{
+    using base_t = std::basic_streambuf<Ch, Tr>;
+
+    std::vector<std::basic_string<Ch, Tr>> pieces_;
+    std::size_t next_;
+    std::function<void(std::size_t)> on_arrival_;
+
+public:
+    using typename base_t::int_type;
+    using typename base_t::traits_type;
+
+    explicit piecewise_streambuf(
+        std::vector<std::basic_string<Ch, Tr>> pieces,
+        std::function<void(std::size_t)> on_arrival = nullptr) :
+        pieces_(std::move(pieces)), next_(0),
+        on_arrival_(std::move(on_arrival))
+    {}
+
+protected:
+    int_type underflow() override
+    {
+        if (this->gptr() < this->egptr()) {
+            return traits_type::to_int_type(*this->gptr());
+        }
+        while (next_ < pieces_.size()) {
+            if (on_arrival_) {
+                on_arrival_(next_);
+            }
+            auto& piece = pieces_[next_++];
+            if (!piece.empty()) {
+                this->setg(piece.data(), piece.data(),
+                    piece.data() + piece.size());
+                return traits_type::to_int_type(*this->gptr());
+            }
+        }
+        return traits_type::eof();
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,69 @@
+/**
+ * These codes are licensed under the Unlicense.
+ * http://unlicense.org
+ */
+
+#ifndef COMMATA_GUARD_CBA07C71_910A_4E91_82DE_D68AA097715C
+#define COMMATA_GUARD_CBA07C71_910A_4E91_82DE_D68AA097715C
+
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace commata::test {
+
+// Collects the values of the fields record by record; if Ch is const, the
+// handler never modifies the chars given, which lets the parser read them
+// directly from the input
+template <class Ch>
+class test_collector
+{
+    using ch_t = std::remove_const_t<Ch>;
+
+    std::vector<std::vector<std::basic_string<ch_t>>>* field_values_;
+    std::basic_string<ch_t> field_value_;
+
+public:
+    using char_type = Ch;
+
+    explicit test_collector(
+        std::vector<std::vector<std::basic_string<ch_t>>>& field_values) :
+        field_values_(&field_values)
+    {}
+
+    void start_record(const ch_t* /*record_begin*/)
+    {
+        field_values_->emplace_back();
+    }
+
+    void update(const ch_t* first, const ch_t* last)
+    {
+        field_value_.append(first, last);
+    }
+
+    void finalize(const ch_t* first, const ch_t* last)
+    {
+        field_value_.append(first, last);
+        field_values_->back().emplace_back();
+        field_values_->back().back().swap(field_value_);
+            // field_value_ is cleared here
+    }
+
+    void end_record(const ch_t* /*record_end*/)
+    {}
+
+protected:
+    const std::basic_string<ch_t>& field_value() const noexcept
+    {
+        return field_value_;
+    }
+
+    const std::vector<std::basic_string<ch_t>>& last_record() const
+    {
+        return field_values_->back();
+    }
+};
+
+}
+
+#endif